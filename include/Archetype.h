@@ -0,0 +1,317 @@
+#pragma once
+#include "ChangeTick.h"
+#include "Entity.h"
+#include "Signature.h"
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+// Archetype storage backend.
+// Entities sharing the same Signature are packed together in fixed-size chunks.
+// Inside a chunk the data is laid out as one column per component (SoA), so
+// reading several components of the same entities stays within one block of
+// memory. Components are moved between chunks with memcpy, which is why they
+// must be trivially copyable. Each component column is followed by a column of
+// its change ticks.
+
+constexpr size_t ARCHETYPE_CHUNK_SIZE = 16 * 1024;
+
+struct ArchetypeChunk {
+    std::unique_ptr<std::byte[]> data;
+    size_t count = 0;
+};
+
+class Archetype {
+  private:
+    static constexpr size_t COLUMN_ALIGN = alignof(std::max_align_t);
+    static constexpr size_t NO_COLUMN = SIZE_MAX;
+
+    Signature _signature;
+    std::array<size_t, MAX_COMPONENTS> _columns; // component type -> column offset in a chunk
+    std::array<size_t, MAX_COMPONENTS> _tickColumns;
+    std::array<size_t, MAX_COMPONENTS> _sizes{};
+    size_t _capacity;
+    std::vector<ArchetypeChunk> _chunks;
+
+    static size_t AlignUp(size_t value) { return (value + COLUMN_ALIGN - 1) & ~(COLUMN_ALIGN - 1); }
+
+  public:
+    Archetype(Signature signature, const std::array<size_t, MAX_COMPONENTS> &componentSizes) : _signature(signature) {
+        size_t rowSize = sizeof(Entity);
+        size_t columnCount = 1;
+
+        _columns.fill(NO_COLUMN);
+        _tickColumns.fill(NO_COLUMN);
+        for (ComponentType type = 0; type < MAX_COMPONENTS; type++) {
+            if (!signature.test(type))
+                continue;
+            _sizes[type] = componentSizes[type];
+            rowSize += componentSizes[type] + sizeof(ComponentTicks);
+            columnCount += 2;
+        }
+
+        // Keep room for the alignment padding of every column
+        _capacity = (ARCHETYPE_CHUNK_SIZE - columnCount * COLUMN_ALIGN) / rowSize;
+        assert(_capacity > 0 && "Archetype row does not fit in a chunk.");
+
+        size_t offset = AlignUp(_capacity * sizeof(Entity));
+        for (ComponentType type = 0; type < MAX_COMPONENTS; type++) {
+            if (!signature.test(type))
+                continue;
+            _columns[type] = offset;
+            offset = AlignUp(offset + _capacity * _sizes[type]);
+            _tickColumns[type] = offset;
+            offset = AlignUp(offset + _capacity * sizeof(ComponentTicks));
+        }
+    }
+
+    Signature GetSignature() const { return _signature; }
+    size_t Capacity() const { return _capacity; }
+    std::vector<ArchetypeChunk> &Chunks() { return _chunks; }
+    const std::vector<ArchetypeChunk> &Chunks() const { return _chunks; }
+
+    Entity *Entities(ArchetypeChunk &chunk) { return reinterpret_cast<Entity *>(chunk.data.get()); }
+
+    void *Column(ArchetypeChunk &chunk, ComponentType type) {
+        assert(_columns[type] != NO_COLUMN && "Component not part of this archetype.");
+
+        return chunk.data.get() + _columns[type];
+    }
+
+    void *Get(size_t chunk, size_t row, ComponentType type) {
+        return static_cast<std::byte *>(Column(_chunks[chunk], type)) + row * _sizes[type];
+    }
+
+    ComponentTicks *Ticks(ArchetypeChunk &chunk, ComponentType type) {
+        assert(_columns[type] != NO_COLUMN && "Component not part of this archetype.");
+
+        return reinterpret_cast<ComponentTicks *>(chunk.data.get() + _tickColumns[type]);
+    }
+
+    ComponentTicks &GetTicks(size_t chunk, size_t row, ComponentType type) { return Ticks(_chunks[chunk], type)[row]; }
+
+    // Appends an entity with uninitialized components, returns its chunk and row.
+    std::pair<size_t, size_t> Allocate(Entity entity) {
+        if (_chunks.empty() || _chunks.back().count == _capacity) {
+            ArchetypeChunk chunk;
+            chunk.data = std::make_unique<std::byte[]>(ARCHETYPE_CHUNK_SIZE);
+            _chunks.push_back(std::move(chunk));
+        }
+
+        ArchetypeChunk &chunk = _chunks.back();
+        size_t row = chunk.count++;
+        Entities(chunk)[row] = entity;
+        return {_chunks.size() - 1, row};
+    }
+
+    // Removes a row by moving the very last row of the archetype into it.
+    // Returns the entity that was moved, or the removed entity itself if it was the last one.
+    Entity Free(size_t chunkIndex, size_t row) {
+        ArchetypeChunk &chunk = _chunks[chunkIndex];
+        ArchetypeChunk &last = _chunks.back();
+        size_t lastRow = last.count - 1;
+        Entity moved = Entities(last)[lastRow];
+
+        if (&chunk != &last || row != lastRow) {
+            Entities(chunk)[row] = moved;
+            for (ComponentType type = 0; type < MAX_COMPONENTS; type++) {
+                if (_columns[type] == NO_COLUMN)
+                    continue;
+                std::memcpy(Get(chunkIndex, row, type), Get(_chunks.size() - 1, lastRow, type), _sizes[type]);
+                GetTicks(chunkIndex, row, type) = GetTicks(_chunks.size() - 1, lastRow, type);
+            }
+        }
+
+        if (--last.count == 0)
+            _chunks.pop_back();
+        return moved;
+    }
+};
+
+class ArchetypeStorage {
+  private:
+    struct Location {
+        Archetype *archetype = nullptr;
+        size_t chunk = 0;
+        size_t row = 0;
+    };
+
+    std::array<size_t, MAX_COMPONENTS> _componentSizes{};
+    std::unordered_map<Signature, std::unique_ptr<Archetype>> _archetypes;
+    std::vector<Archetype *> _archetypeList;
+    std::vector<Location> _locations;
+
+    // Grows _locations, for the paths placing entities only: concurrent systems read through FindLocation()
+    Location &GetLocation(Entity entity) {
+        if (EntityIndex(entity) >= _locations.size())
+            _locations.resize(EntityIndex(entity) + 1);
+        return _locations[EntityIndex(entity)];
+    }
+
+    // An empty location for an entity that never had components
+    Location FindLocation(Entity entity) const {
+        return EntityIndex(entity) < _locations.size() ? _locations[EntityIndex(entity)] : Location{};
+    }
+
+    Archetype *GetArchetype(Signature signature) {
+        auto it = _archetypes.find(signature);
+
+        if (it != _archetypes.end())
+            return it->second.get();
+
+        auto archetype = std::make_unique<Archetype>(signature, _componentSizes);
+        Archetype *raw = archetype.get();
+        _archetypes.emplace(signature, std::move(archetype));
+        _archetypeList.push_back(raw);
+        return raw;
+    }
+
+    void Release(Location &location) {
+        Entity moved = location.archetype->Free(location.chunk, location.row);
+        Location &movedLocation = GetLocation(moved);
+
+        if (&movedLocation != &location) {
+            movedLocation.chunk = location.chunk;
+            movedLocation.row = location.row;
+        }
+    }
+
+    // Moves the entity to the archetype of the new signature, keeping the shared components.
+    void Move(Entity entity, Signature signature) {
+        Location &location = GetLocation(entity);
+        Archetype *from = location.archetype;
+        Archetype *to = signature.none() ? nullptr : GetArchetype(signature);
+
+        if (from == to)
+            return;
+
+        Location next{to, 0, 0};
+        if (to) {
+            auto [chunk, row] = to->Allocate(entity);
+            next.chunk = chunk;
+            next.row = row;
+
+            if (from) {
+                Signature shared = from->GetSignature() & signature;
+                for (ComponentType type = 0; type < MAX_COMPONENTS; type++) {
+                    if (!shared.test(type))
+                        continue;
+                    std::memcpy(to->Get(chunk, row, type), from->Get(location.chunk, location.row, type),
+                                _componentSizes[type]);
+                    to->GetTicks(chunk, row, type) = from->GetTicks(location.chunk, location.row, type);
+                }
+            }
+        }
+
+        if (from)
+            Release(location);
+        location = next;
+    }
+
+  public:
+    void RegisterComponent(ComponentType type, size_t size) { _componentSizes[type] = size; }
+
+    void Add(Entity entity, ComponentType type, const void *component) {
+        Signature signature = GetSignature(entity);
+
+        assert(!signature.test(type) && "Component added to same entity more than once.");
+
+        signature.set(type, true);
+        Move(entity, signature);
+
+        Location &location = GetLocation(entity);
+        std::memcpy(location.archetype->Get(location.chunk, location.row, type), component, _componentSizes[type]);
+        Tick now = ChangeTicks::Now();
+        location.archetype->GetTicks(location.chunk, location.row, type) = ComponentTicks{now, now};
+    }
+
+    // Places entities without components straight into the archetype of `signature`,
+    // each getting a copy of components[type] for every type in it.
+    void Insert(std::span<const Entity> entities, Signature signature, const std::array<const void *, MAX_COMPONENTS> &components) {
+        Archetype *archetype = GetArchetype(signature);
+        Tick now = ChangeTicks::Now();
+
+        for (Entity entity : entities) {
+            Location &location = GetLocation(entity);
+
+            assert(!location.archetype && "Batch insert of an entity that already has components.");
+
+            auto [chunk, row] = archetype->Allocate(entity);
+            location = Location{archetype, chunk, row};
+            for (ComponentType type = 0; type < MAX_COMPONENTS; type++) {
+                if (!signature.test(type))
+                    continue;
+                std::memcpy(archetype->Get(chunk, row, type), components[type], _componentSizes[type]);
+                archetype->GetTicks(chunk, row, type) = ComponentTicks{now, now};
+            }
+        }
+    }
+
+    void Remove(Entity entity, ComponentType type) {
+        Signature signature = GetSignature(entity);
+
+        assert(signature.test(type) && "Removing non existence component.");
+
+        signature.set(type, false);
+        Move(entity, signature);
+    }
+
+    void *Get(Entity entity, ComponentType type) const {
+        Location location = FindLocation(entity);
+
+        assert(location.archetype && location.archetype->GetSignature().test(type) && "Try to get non existence component.");
+
+        return location.archetype->Get(location.chunk, location.row, type);
+    }
+
+    ComponentTicks &GetTicks(Entity entity, ComponentType type) const {
+        Location location = FindLocation(entity);
+
+        assert(location.archetype && location.archetype->GetSignature().test(type) && "Try to get non existence component.");
+
+        return location.archetype->GetTicks(location.chunk, location.row, type);
+    }
+
+    bool Has(Entity entity, ComponentType type) const {
+        Location location = FindLocation(entity);
+
+        // A stale handle shares its location slot with the entity that reused the index
+        if (!location.archetype || !location.archetype->GetSignature().test(type))
+            return false;
+        return location.archetype->Entities(location.archetype->Chunks()[location.chunk])[location.row] == entity;
+    }
+
+    Signature GetSignature(Entity entity) const {
+        Location location = FindLocation(entity);
+        return location.archetype ? location.archetype->GetSignature() : Signature{};
+    }
+
+    void EntityDestroyed(Entity entity) { Move(entity, Signature{}); }
+
+    // Drops every archetype and the data they hold; component sizes stay registered.
+    void Clear() {
+        _archetypes.clear();
+        _archetypeList.clear();
+        _locations.clear();
+    }
+
+    // Calls func(archetype) for every archetype containing all the required components.
+    template <typename Func> void EachArchetype(Signature required, Func &&func) {
+        for (Archetype *archetype : _archetypeList) {
+            if ((archetype->GetSignature() & required) == required)
+                func(*archetype);
+        }
+    }
+
+    size_t ChunkCount() const {
+        size_t count = 0;
+        for (Archetype *archetype : _archetypeList)
+            count += archetype->Chunks().size();
+        return count;
+    }
+};
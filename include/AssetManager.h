@@ -0,0 +1,148 @@
+#pragma once
+
+#include "EngineApi.h"
+#include "raylib.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Roar {
+
+// Small integer reference to a texture owned by the AssetManager.
+// The low 16 bits are the slot index + 1, the high 16 bits its generation, so a
+// handle to an evicted texture never resolves to the one that reused its slot.
+struct TextureHandle {
+    uint32_t id = 0;
+
+    explicit operator bool() const { return id != 0; }
+    bool operator==(const TextureHandle &) const = default;
+};
+
+// Where a texture is in its load. Synchronous loads go straight to Ready.
+enum class AssetState : uint8_t {
+    Invalid,  // null or stale handle
+    Decoding, // file read and decode running on the job pool
+    Decoded,  // CPU image waiting for its GPU upload in Update()
+    Ready,
+    Failed,
+};
+
+struct AssetStats {
+    size_t textureCount = 0;
+    size_t textureBytes = 0; // GPU memory of the loaded textures, mipmaps included
+    size_t loads = 0;
+    size_t cacheHits = 0;
+    size_t evictions = 0;
+    double loadMs = 0.0;   // time spent in LoadTexture
+    double decodeMs = 0.0; // worker time spent reading and decoding async loads
+    double uploadMs = 0.0; // main thread time spent uploading them
+    size_t pending = 0;    // async loads not uploaded yet
+};
+
+// Loads each texture path once and hands out reference-counted handles.
+// A texture is unloaded when its last reference is released. Copying a handle,
+// e.g. inside a component, does not take a reference: whoever acquired it keeps it.
+// Main thread only, like every raylib GPU call. Async loads decode on the job pool
+// and are uploaded by Update() within a per-frame time budget.
+class ENGINE_API AssetManager {
+  public:
+    AssetManager() = default;
+    // Waits for the decodes still running, they write into this manager
+    ~AssetManager();
+
+    AssetManager(const AssetManager &) = delete;
+    AssetManager &operator=(const AssetManager &) = delete;
+
+    // Takes a reference on the texture of `path`, loading it on first use. Null handle if loading failed.
+    // A path still loading asynchronously is waited for and uploaded at once.
+    TextureHandle AcquireTexture(const std::string &path);
+
+    // Uploads an image built in memory, e.g. an atlas page, and caches it under `name` like a path.
+    // A name already cached is returned without uploading `image`.
+    TextureHandle AcquireTexture(const std::string &name, const Image &image);
+
+    // Same as AcquireTexture() but returns at once, the file being read and decoded on the job
+    // pool. The handle draws as nothing until Update() has uploaded it.
+    TextureHandle AcquireTextureAsync(const std::string &path);
+
+    // Collects the finished decodes and uploads them, stopping once `budgetMs` is spent.
+    // At least one texture is uploaded per call so a small budget still makes progress.
+    void Update(double budgetMs);
+
+    // Moves the finished decodes into their slots without uploading them. Update() calls it;
+    // headless code can call it alone and read the decoded images.
+    void Collect();
+
+    // Blocks until the decode of `handle` is done, running pool jobs meanwhile.
+    void WaitDecoded(TextureHandle handle);
+
+    AssetState GetState(TextureHandle handle) const;
+    bool IsReady(TextureHandle handle) const { return GetState(handle) == AssetState::Ready; }
+
+    // The CPU image of a Decoded texture, null in any other state.
+    const Image *GetImage(TextureHandle handle) const;
+
+    // Takes one more reference on a live handle.
+    void Acquire(TextureHandle handle);
+
+    // Drops a reference, unloading the texture if it was the last one.
+    void Release(TextureHandle handle);
+
+    bool IsValid(TextureHandle handle) const;
+
+    // An empty texture (id 0) for null or stale handles, which raylib draws as nothing.
+    // The reference is only valid until the next AcquireTexture() or AcquireTextureAsync().
+    const Texture2D &GetTexture(TextureHandle handle) const;
+
+    const AssetStats &GetStats() const { return _stats; }
+
+    // Unloads every texture regardless of references. Must run before the window closes:
+    // the textures left at exit are not unloaded, the GPU context being gone by then.
+    void Clear();
+
+  private:
+    static constexpr uint32_t INDEX_MASK = 0xFFFF;
+
+    struct TextureSlot {
+        Texture2D texture{};
+        Image image{};
+        std::string path;
+        uint32_t refCount = 0;
+        uint16_t generation = 0;
+        AssetState state = AssetState::Invalid;
+        size_t bytes = 0;
+    };
+
+    // Decode result handed from a worker to the main thread
+    struct DecodedImage {
+        TextureHandle handle;
+        Image image;
+        double decodeMs;
+    };
+
+    std::vector<TextureSlot> _textures;
+    std::vector<uint32_t> _freeSlots;
+    std::unordered_map<std::string, TextureHandle> _byPath;
+    AssetStats _stats;
+
+    std::mutex _decodedMutex;
+    std::vector<DecodedImage> _decoded;
+    std::atomic<uint32_t> _decoding{0};
+
+    TextureSlot *Resolve(TextureHandle handle);
+    const TextureSlot *Resolve(TextureHandle handle) const;
+    TextureHandle AllocateSlot(const std::string &path);
+    TextureHandle AddTexture(const std::string &path, Texture2D texture);
+    void Upload(TextureSlot &slot);
+    void Evict(uint32_t index);
+};
+
+// Engine-wide asset cache.
+ENGINE_API AssetManager &Assets();
+
+} // namespace Roar
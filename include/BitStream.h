@@ -0,0 +1,277 @@
+#pragma once
+
+#include "INetwork.h"
+
+#include <bit>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+namespace Roar {
+
+// Packs values of any bit width back to back into the bytes of an INetBuffer, least significant bit first.
+// The last byte only reaches the buffer on Flush().
+class BitWriter {
+  private:
+    INetBuffer &_buffer;
+    uint64_t _scratch = 0;
+    int _scratchBits = 0;
+    size_t _bits = 0;
+
+  public:
+    explicit BitWriter(INetBuffer &buffer) : _buffer(buffer) {}
+
+    void WriteBits(uint32_t value, int count) {
+        assert(count >= 0 && count <= 32 && "BitWriter: at most 32 bits at a time");
+        if (count < 32)
+            value &= (1u << count) - 1;
+
+        _scratch |= (uint64_t)value << _scratchBits;
+        _scratchBits += count;
+        _bits += count;
+        while (_scratchBits >= 8) {
+            _buffer.WriteUInt8((uint8_t)_scratch);
+            _scratch >>= 8;
+            _scratchBits -= 8;
+        }
+    }
+
+    void WriteBool(bool value) { WriteBits(value ? 1 : 0, 1); }
+
+    // 7 bits at a time, each group followed by a bit telling whether another one comes
+    void WriteVarUInt(uint32_t value) {
+        while (value >= 0x80) {
+            WriteBits((value & 0x7F) | 0x80, 8);
+            value >>= 7;
+        }
+        WriteBits(value, 8);
+    }
+
+    // Zigzag encoded, small negative values stay short
+    void WriteVarInt(int32_t value) { WriteVarUInt(((uint32_t)value << 1) ^ (uint32_t)(value >> 31)); }
+
+    // Pads the last byte with zeros and writes it
+    void Flush() {
+        if (_scratchBits > 0) {
+            _buffer.WriteUInt8((uint8_t)_scratch);
+            _bits += 8 - _scratchBits;
+        }
+        _scratch = 0;
+        _scratchBits = 0;
+    }
+
+    size_t GetBitCount() const { return _bits; }
+};
+
+// Reads back what a BitWriter wrote, taking bytes from the buffer only as they are needed. Past the end of
+// the buffer every bit reads as zero.
+class BitReader {
+  private:
+    INetBuffer &_buffer;
+    uint64_t _scratch = 0;
+    int _scratchBits = 0;
+
+  public:
+    explicit BitReader(INetBuffer &buffer) : _buffer(buffer) {}
+
+    uint32_t ReadBits(int count) {
+        assert(count >= 0 && count <= 32 && "BitReader: at most 32 bits at a time");
+        while (_scratchBits < count) {
+            _scratch |= (uint64_t)_buffer.ReadUInt8() << _scratchBits;
+            _scratchBits += 8;
+        }
+
+        uint32_t value = (uint32_t)(_scratch & ((1ull << count) - 1));
+        _scratch >>= count;
+        _scratchBits -= count;
+        return value;
+    }
+
+    bool ReadBool() { return ReadBits(1) != 0; }
+
+    uint32_t ReadVarUInt() {
+        uint32_t value = 0;
+
+        for (int shift = 0; shift < 35; shift += 7) {
+            uint32_t group = ReadBits(8);
+            value |= (group & 0x7F) << shift;
+            if (!(group & 0x80))
+                break;
+        }
+        return value;
+    }
+
+    int32_t ReadVarInt() {
+        uint32_t value = ReadVarUInt();
+        return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+    }
+
+    // Drops the padding of the current byte, for data written after a BitWriter::Flush()
+    void Align() {
+        _scratch = 0;
+        _scratchBits = 0;
+    }
+};
+
+// Maps `value` clamped to [min, max] onto 2^bits evenly spaced steps. Dequantize(Quantize(x)) quantizes
+// back to the same step, so a value that went over the wire once compares equal to itself afterwards.
+inline uint32_t Quantize(float value, float min, float max, int bits) {
+    uint32_t steps = (uint32_t)((1ull << bits) - 1);
+
+    // Written so that NaN lands on min
+    if (!(value > min))
+        return 0;
+    if (value >= max)
+        return steps;
+    return (uint32_t)std::lround((double)(value - min) / (max - min) * steps);
+}
+
+inline float Dequantize(uint32_t quantized, float min, float max, int bits) {
+    uint32_t steps = (uint32_t)((1ull << bits) - 1);
+    return (float)(min + (double)(max - min) * quantized / steps);
+}
+
+enum class FieldEncoding : uint8_t {
+    Bool,      // bool, one bit
+    Bits,      // uint32_t below 2^bits
+    VarUInt,   // uint32_t, 8 bits per 7 significant bits
+    VarInt,    // int32_t, zigzag then VarUInt
+    RangedInt, // int clamped to [min, max]
+    Quantized, // float clamped to [min, max] over 2^bits steps
+    Float      // float, all 32 bits
+};
+
+// How one member of a plain struct goes on the wire, found at `offset` bytes into it
+struct FieldSchema {
+    FieldEncoding encoding;
+    size_t offset;
+    int bits = 0;
+    float min = 0.0f;
+    float max = 0.0f;
+};
+
+constexpr FieldSchema BoolField(size_t offset) { return FieldSchema{FieldEncoding::Bool, offset, 1}; }
+constexpr FieldSchema BitsField(size_t offset, int bits) { return FieldSchema{FieldEncoding::Bits, offset, bits}; }
+constexpr FieldSchema VarUIntField(size_t offset) { return FieldSchema{FieldEncoding::VarUInt, offset}; }
+constexpr FieldSchema VarIntField(size_t offset) { return FieldSchema{FieldEncoding::VarInt, offset}; }
+constexpr FieldSchema FloatField(size_t offset) { return FieldSchema{FieldEncoding::Float, offset, 32}; }
+
+constexpr FieldSchema RangedIntField(size_t offset, int min, int max) {
+    return FieldSchema{FieldEncoding::RangedInt, offset, (int)std::bit_width((uint32_t)(max - min)), (float)min, (float)max};
+}
+
+constexpr FieldSchema QuantizedField(size_t offset, float min, float max, int bits) {
+    return FieldSchema{FieldEncoding::Quantized, offset, bits, min, max};
+}
+
+// The field as the 32 bits the encoding carries
+inline uint32_t FieldWireValue(const FieldSchema &field, const void *object) {
+    const uint8_t *member = (const uint8_t *)object + field.offset;
+    uint32_t bits;
+    int32_t integer;
+    float real;
+
+    switch (field.encoding) {
+    case FieldEncoding::Bool:
+        return *(const bool *)member ? 1 : 0;
+    case FieldEncoding::VarInt:
+        memcpy(&integer, member, sizeof(int32_t));
+        return ((uint32_t)integer << 1) ^ (uint32_t)(integer >> 31);
+    case FieldEncoding::RangedInt:
+        memcpy(&integer, member, sizeof(int32_t));
+        integer = integer < (int32_t)field.min ? (int32_t)field.min : integer > (int32_t)field.max ? (int32_t)field.max : integer;
+        return (uint32_t)(integer - (int32_t)field.min);
+    case FieldEncoding::Quantized:
+        memcpy(&real, member, sizeof(float));
+        return Quantize(real, field.min, field.max, field.bits);
+    default:
+        memcpy(&bits, member, sizeof(uint32_t));
+        return bits;
+    }
+}
+
+inline void SetFieldWireValue(const FieldSchema &field, void *object, uint32_t value) {
+    uint8_t *member = (uint8_t *)object + field.offset;
+    int32_t integer;
+    float real;
+
+    switch (field.encoding) {
+    case FieldEncoding::Bool:
+        *(bool *)member = value != 0;
+        break;
+    case FieldEncoding::VarInt:
+        integer = (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+        memcpy(member, &integer, sizeof(int32_t));
+        break;
+    case FieldEncoding::RangedInt:
+        integer = (int32_t)value + (int32_t)field.min;
+        memcpy(member, &integer, sizeof(int32_t));
+        break;
+    case FieldEncoding::Quantized:
+        real = Dequantize(value, field.min, field.max, field.bits);
+        memcpy(member, &real, sizeof(float));
+        break;
+    default:
+        memcpy(member, &value, sizeof(uint32_t));
+        break;
+    }
+}
+
+inline void WriteField(BitWriter &writer, const FieldSchema &field, const void *object) {
+    uint32_t value = FieldWireValue(field, object);
+
+    if (field.encoding == FieldEncoding::VarUInt || field.encoding == FieldEncoding::VarInt)
+        writer.WriteVarUInt(value);
+    else
+        writer.WriteBits(value, field.bits);
+}
+
+inline void ReadField(BitReader &reader, const FieldSchema &field, void *object) {
+    if (field.encoding == FieldEncoding::VarUInt || field.encoding == FieldEncoding::VarInt)
+        SetFieldWireValue(field, object, reader.ReadVarUInt());
+    else
+        SetFieldWireValue(field, object, reader.ReadBits(field.bits));
+}
+
+inline void WriteFields(BitWriter &writer, std::span<const FieldSchema> schema, const void *object) {
+    for (const FieldSchema &field : schema)
+        WriteField(writer, field, object);
+}
+
+inline void ReadFields(BitReader &reader, std::span<const FieldSchema> schema, void *object) {
+    for (const FieldSchema &field : schema)
+        ReadField(reader, field, object);
+}
+
+// Whether `object` and `base` differ once encoded. Changes finer than a quantization step do not count.
+inline bool FieldsChanged(std::span<const FieldSchema> schema, const void *object, const void *base) {
+    for (const FieldSchema &field : schema) {
+        if (FieldWireValue(field, object) != FieldWireValue(field, base))
+            return true;
+    }
+    return false;
+}
+
+// One bit per field, set and followed by the field when it differs from `base` once encoded
+inline void WriteFieldsDelta(BitWriter &writer, std::span<const FieldSchema> schema, const void *object, const void *base) {
+    for (const FieldSchema &field : schema) {
+        bool changed = FieldWireValue(field, object) != FieldWireValue(field, base);
+
+        writer.WriteBool(changed);
+        if (changed)
+            WriteField(writer, field, object);
+    }
+}
+
+// `object` holds the base the delta was written against, fields flagged as changed are overwritten
+inline void ReadFieldsDelta(BitReader &reader, std::span<const FieldSchema> schema, void *object) {
+    for (const FieldSchema &field : schema) {
+        if (reader.ReadBool())
+            ReadField(reader, field, object);
+    }
+}
+
+} // namespace Roar
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "AssetManager.h"
 #include "IPhysics.h"
 #include "box2d/box2d.h"
 #include "raylib.h"
@@ -31,8 +32,8 @@ class Box2DPhysics : public IPhysics {
     uint32_t HEIGHT = 1080;
 
     struct DemoData {
-        Texture groundTexture;
-        Texture boxTexture;
+        TextureHandle groundTexture;
+        TextureHandle boxTexture;
         bool pause;
         float lengthUnitsPerMeter;
         b2WorldDef worldDef;
@@ -11,7 +11,7 @@ class EntityBuilder {
   public:
     EntityBuilder(Entity entity) : _entity(entity) {};
     template <typename... args> void BuildEntity(Scene &_core, args &&...comps) {
-        (_core.AddComponent(_entity, std::forward<args>(comps)), ...);
+        _core.AddComponents(_entity, std::forward<args>(comps)...);
     };
 };
 
@@ -33,4 +33,25 @@ class SystemBuilder {
         _core.SetSystemSignature<Sys>(_signature);
     }
 };
+
+// Declares the components a system reads and writes, so the scheduler can run it alongside others:
+// AccessBuilder().Read<Velocity>(_core).Write<Position>(_core).BuildAccess<VelocitySystem>(_core);
+class AccessBuilder {
+  private:
+    Signature _reads;
+    Signature _writes;
+
+  public:
+    template <typename... TComponents> AccessBuilder &Read(Scene &_core) {
+        (_reads.set(_core.GetComponentType<TComponents>(), true), ...);
+        return *this;
+    }
+
+    template <typename... TComponents> AccessBuilder &Write(Scene &_core) {
+        (_writes.set(_core.GetComponentType<TComponents>(), true), ...);
+        return *this;
+    }
+
+    template <typename Sys> void BuildAccess(Scene &_core) { _core.SetSystemAccess<Sys>(_reads, _writes); }
+};
 } // namespace MiniBuilder
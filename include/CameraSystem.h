@@ -10,7 +10,7 @@ class CameraSystem : public System {
     void Update() override {
         float followSpeed = 0.1f;
 
-        for (auto entity : _entities) {
+        for (auto entity : Entities()) {
             if (!_core.HasComponent<CameraComponent>(entity))
                 continue;
 
@@ -27,23 +27,23 @@ class CameraSystem : public System {
 class CameraFollowSystem : public System {
   public:
     void Update() override {
-        Entity playerEntity = -1;
+        Entity playerEntity = NULL_ENTITY;
 
         // find local player
-        for (auto entity : _entities) {
+        for (auto entity : Entities()) {
             if (_core.HasComponent<Position>(entity) && _core.HasComponent<LocalPlayerTag>(entity)) {
                 playerEntity = entity;
                 break;
             }
         }
 
-        if (playerEntity == -1)
+        if (playerEntity == NULL_ENTITY)
             return;
 
         auto &playerPos = _core.GetComponent<Position>(playerEntity);
 
         // update camera target
-        for (auto entity : _entities) {
+        for (auto entity : Entities()) {
             if (!_core.HasComponent<CameraComponent>(entity))
                 continue;
 
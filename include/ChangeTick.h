@@ -0,0 +1,39 @@
+#pragma once
+#include "EcsApi.h"
+#include <cstdint>
+
+// Change detection.
+// Every system run gets a new tick from a process-wide counter, and component
+// writes are stamped with the tick of the system doing them. A system asking for
+// changes sees every stamp newer than its previous run, so it never misses a
+// write and never sees its own writes twice.
+using Tick = std::uint32_t;
+
+struct ComponentTicks {
+    Tick added;
+    Tick changed;
+};
+
+namespace ChangeTicks {
+
+// Tick the calling thread stamps writes with. Outside of a system it is the tick of the next system run.
+ECS_API Tick Now();
+
+// Tick of the previous run of the system running on this thread, 0 outside of a system.
+ECS_API Tick LastRun();
+
+// Change tick state of the system running on a thread.
+struct SystemRun {
+    bool active = false;
+    Tick now = 0;
+    Tick lastRun = 0;
+};
+
+// Enters a system run on this thread and returns the tick of that run. `outer` receives the run it
+// interrupts: a thread waiting in a ParallelFor may pick up another system's job.
+ECS_API Tick BeginSystem(Tick lastRun, SystemRun &outer);
+
+// Leaves the system run, back to the `outer` one BeginSystem() saved.
+ECS_API void EndSystem(const SystemRun &outer);
+
+} // namespace ChangeTicks
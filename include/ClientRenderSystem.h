@@ -5,13 +5,15 @@
 
 class ClientRendererSystem : public System {
 private:
-    Texture2D* m_playerTexture;
+    Roar::TextureHandle m_playerTexture;
     Rectangle sourcerec;
     Rectangle destrec;
     Rectangle rec;
     Vector2 origin = { 0.0f, 0.0f };
 public:
-    void SetPlayerTexture(Texture2D* texture) {
+    ClientRendererSystem() { mainThread = true; }
+
+    void SetPlayerTexture(Roar::TextureHandle texture) {
         m_playerTexture = texture;
     }
 
@@ -27,7 +29,7 @@ public:
         rec = { pos.position.x, pos.position.y, frameWidth * 2.0f, frameHeight * 2.0f };
         destrec = { pos.position.x, pos.position.y, frameWidth * 2.0f, frameHeight * 2.0f };
 
-        DrawTexturePro(*m_playerTexture, sourcerec, destrec, origin, 0.0f, sprite.color);
+        DrawTexturePro(Roar::Assets().GetTexture(m_playerTexture), sourcerec, destrec, origin, 0.0f, sprite.color);
 
         // Draw rectangle around local player
         if (netClient.is_local) {
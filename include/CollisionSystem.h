@@ -8,9 +8,11 @@
 
 extern Scene _core;
 
-void check_map_collision(Position &pos, Collider &collider) {
+// Returns true if the position had to be moved back on screen.
+bool check_map_collision(Position &pos, const Collider &collider) {
     float screenW = (float)GetScreenWidth();
     float screenH = (float)GetScreenHeight();
+    Vector2 previous = pos.position;
 
     if (pos.position.x + collider.rect.width >= screenW)
         pos.position.x = screenW - collider.rect.width;
@@ -24,8 +26,7 @@ void check_map_collision(Position &pos, Collider &collider) {
     if (pos.position.y <= 0)
         pos.position.y = 0;
 
-    collider.rect.x = pos.position.x;
-    collider.rect.y = pos.position.y;
+    return pos.position.x != previous.x || pos.position.y != previous.y;
 }
 
 void check_enemy_collision(Rectangle &rectA, Rectangle &rectB) {
@@ -40,19 +41,25 @@ void check_enemy_collision(Rectangle &rectA, Rectangle &rectB) {
 class CollisionSystem : public System {
   public:
     void Update() override {
-        bool collision;
         Rectangle rectA;
         Rectangle rectB;
-        for (auto &entity : _entities) {
-            auto &pos = _core.GetComponent<Position>(entity);
-            auto &collider = _core.GetComponent<Collider>(entity);
-            if (collider.isPlayer) {
+
+        // Only colliders whose position moved since the last run need to follow it. Position is written
+        // back on screen for players, the view stamps it.
+        _core.View<Position, Collider>().Changed<Position>().Each([&](Position &pos, Collider &collider) {
+            if (collider.isPlayer)
                 check_map_collision(pos, collider);
+            collider.rect.x = pos.position.x;
+            collider.rect.y = pos.position.y;
+        });
+
+        _core.View<const Collider>().Each([&](const Collider &collider) {
+            if (collider.isPlayer)
                 rectA = collider.rect;
-            } else if (!collider.isPlayer)
+            else
                 rectB = collider.rect;
             // check enemy collision
             check_enemy_collision(rectA, rectB);
-        }
+        });
     }
 };
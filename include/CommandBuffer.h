@@ -0,0 +1,91 @@
+#pragma once
+#include "Component.h"
+#include "EcsApi.h"
+#include "Entity.h"
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+class Scene;
+
+// Records structural changes (create, destroy, add, remove) to be applied later
+// by Scene::FlushCommands(), so systems can request them while iterating a view
+// or from a worker thread. Scene keeps one buffer per job pool thread.
+// Commands are applied in recording order; each touched entity gets a single
+// system membership update once its commands are applied.
+class ECS_API CommandBuffer {
+  public:
+    // Entity created by this buffer, only usable with this buffer until playback.
+    struct PendingEntity {
+        uint32_t index;
+    };
+
+  private:
+    enum class Op : uint8_t { Create, Destroy, Add, Remove };
+
+    using Apply = void (*)(Scene &, Entity, const std::byte *);
+
+    struct Command {
+        Op op;
+        bool pending; // target is a PendingEntity index
+        uint32_t target;
+        size_t offset; // component bytes in _data
+        Apply apply;
+    };
+
+    std::vector<Command> _commands{};
+    std::vector<std::byte> _data{};
+    std::vector<Entity> _created{};
+    std::vector<Entity> _touched{};
+    uint32_t _pendingCount = 0;
+
+    template <typename T> size_t Store(const T &component) {
+        static_assert(std::is_trivially_copyable_v<T>, "Deferred components must be trivially copyable.");
+
+        size_t offset = (_data.size() + alignof(T) - 1) / alignof(T) * alignof(T);
+        _data.resize(offset + sizeof(T));
+        std::memcpy(_data.data() + offset, &component, sizeof(T));
+        return offset;
+    }
+
+    // Defined in Scene.h, once Scene is complete.
+    template <typename T> static void ApplyAdd(Scene &scene, Entity entity, const std::byte *data);
+    template <typename T> static void ApplyRemove(Scene &scene, Entity entity, const std::byte *data);
+
+  public:
+    PendingEntity CreateEntity() {
+        _commands.push_back(Command{Op::Create, true, _pendingCount, 0, nullptr});
+        return PendingEntity{_pendingCount++};
+    }
+
+    void DestroyEntity(Entity entity) { _commands.push_back(Command{Op::Destroy, false, entity, 0, nullptr}); }
+
+    void DestroyEntity(PendingEntity entity) { _commands.push_back(Command{Op::Destroy, true, entity.index, 0, nullptr}); }
+
+    // Adds the component, or overwrites it if the entity already has one.
+    template <typename T> void AddComponent(Entity entity, T component) {
+        _commands.push_back(Command{Op::Add, false, entity, Store(component), &ApplyAdd<T>});
+    }
+
+    template <typename T> void AddComponent(PendingEntity entity, T component) {
+        _commands.push_back(Command{Op::Add, true, entity.index, Store(component), &ApplyAdd<T>});
+    }
+
+    template <typename... Ts> void AddComponents(PendingEntity entity, Ts... components) {
+        (AddComponent<Ts>(entity, components), ...);
+    }
+
+    // Does nothing if the entity no longer has the component by then.
+    template <typename T> void RemoveComponent(Entity entity) {
+        _commands.push_back(Command{Op::Remove, false, entity, 0, &ApplyRemove<T>});
+    }
+
+    bool Empty() const { return _commands.empty(); }
+    size_t Size() const { return _commands.size(); }
+
+    // Applies and clears the recorded commands. Commands on entities that died in the meantime are dropped.
+    void Playback(Scene &scene);
+};
@@ -1,4 +1,5 @@
 #pragma once
+#include "AssetManager.h"
 #include <array>
 #include <cstdint>
 #include <raylib.h>
@@ -34,14 +35,24 @@ struct Velocity {
 
 struct Sprite {
     Color color;
+    Roar::TextureHandle texture{};
+    uint16_t layer = 0; // higher layers draw on top
 };
 
+// Draw layers of the r-type sprites
+enum SpriteLayer : uint16_t {
+    LAYER_ENEMIES = 1,
+    LAYER_PLAYERS = 2,
+    LAYER_MISSILES = 3,
+};
+
+// Sprite textures are borrowed, whoever acquired the handle (an atlas, the client) releases it
 struct PlayerSprite {
-    Texture2D texture;
+    Roar::TextureHandle texture;
 };
 
 struct EnemySprite {
-    Texture2D texture;
+    Roar::TextureHandle texture;
 };
 
 struct Collider {
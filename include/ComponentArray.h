@@ -1,61 +1,107 @@
 #pragma once
+#include "ChangeTick.h"
 #include "Component.h"
 #include "Entity.h"
+#include "PagedArray.h"
 #include "Signature.h"
+#include "SparseSet.h"
 #include <cassert>
-#include <unordered_map>
+#include <span>
 
 class IComponentArray {
   public:
     virtual ~IComponentArray() = default;
     virtual void EntityDestroyed(Entity entity) = 0;
+    virtual size_t MemoryUsage() const = 0;
+    virtual void Clear() = 0;
+    // Gives every entity a copy of *component, which must point to this array's component type.
+    virtual void InsertCopies(std::span<const Entity> entities, const void *component) = 0;
 };
 
 template <typename T> class ComponentArray : public IComponentArray {
   private:
-    std::array<T, MAX_ENTITIES> _componentArray;
-    std::unordered_map<Entity, size_t> _entityToIndexMap;
-    std::unordered_map<size_t, Entity> _indexToEntityMap;
-    size_t size;
+    PagedArray<T> _componentArray;
+    PagedArray<ComponentTicks> _ticks; // parallel to _componentArray
+    SparseSet _entities;
 
   public:
     void InsertData(Entity entity, T component) {
-        assert(_entityToIndexMap.find(entity) == _entityToIndexMap.end() && "Component added to same entity more than once.");
+        assert(!_entities.Contains(entity) && "Component added to same entity more than once.");
 
-        size_t newIndex = size;
-        _entityToIndexMap[entity] = newIndex;
-        _indexToEntityMap[newIndex] = entity;
-        _componentArray[newIndex] = component;
-        size++;
+        _entities.Insert(entity);
+        _componentArray.PushBack(component);
+        Tick now = ChangeTicks::Now();
+        _ticks.PushBack(ComponentTicks{now, now});
     }
 
-    void RemoveData(Entity entity) {
-        assert(_entityToIndexMap.find(entity) != _entityToIndexMap.end() && "Removing non existence entity.");
+    // Gives every entity a copy of the same component.
+    void InsertData(std::span<const Entity> entities, const T &component) {
+        Reserve(Size() + entities.size());
+
+        Tick now = ChangeTicks::Now();
+        for (Entity entity : entities) {
+            assert(!_entities.Contains(entity) && "Component added to same entity more than once.");
+
+            _entities.Insert(entity);
+            _componentArray.PushBack(component);
+            _ticks.PushBack(ComponentTicks{now, now});
+        }
+    }
 
-        size_t indexOfRemovedEntity = _entityToIndexMap[entity];
-        size_t indexOfLastElement = size - 1;
-        _componentArray[indexOfRemovedEntity] = _componentArray[indexOfLastElement];
+    void InsertCopies(std::span<const Entity> entities, const void *component) override {
+        InsertData(entities, *static_cast<const T *>(component));
+    }
 
-        Entity entityOfLastElement = _indexToEntityMap[indexOfLastElement];
-        _entityToIndexMap[entityOfLastElement] = indexOfRemovedEntity;
-        _indexToEntityMap[indexOfRemovedEntity] = entityOfLastElement;
+    void RemoveData(Entity entity) {
+        assert(_entities.Contains(entity) && "Removing non existence entity.");
 
-        _entityToIndexMap.erase(entity);
-        _indexToEntityMap.erase(indexOfLastElement);
+        size_t indexOfRemovedEntity = _entities.Index(entity);
+        _componentArray[indexOfRemovedEntity] = _componentArray.Back();
+        _componentArray.PopBack();
+        _ticks[indexOfRemovedEntity] = _ticks.Back();
+        _ticks.PopBack();
 
-        size--;
+        _entities.Remove(entity);
     }
 
     T &GetData(Entity entity) {
-        assert(_entityToIndexMap.find(entity) != _entityToIndexMap.end() && "Try to get data of non existence entity.");
+        assert(_entities.Contains(entity) && "Try to get data of non existence entity.");
 
-        return _componentArray[_entityToIndexMap[entity]];
+        return _componentArray[_entities.Index(entity)];
     }
 
     void EntityDestroyed(Entity entity) override {
-        if (_entityToIndexMap.find(entity) != _entityToIndexMap.end())
+        if (_entities.Contains(entity))
             RemoveData(entity);
     }
 
-    bool HasData(Entity entity) const { return _entityToIndexMap.find(entity) != _entityToIndexMap.end(); }
+    void Clear() override {
+        _entities.Clear();
+        _componentArray.Clear();
+        _ticks.Clear();
+    }
+
+    bool HasData(Entity entity) const { return _entities.Contains(entity); }
+
+    void Reserve(size_t capacity) {
+        _entities.Reserve(capacity);
+        _componentArray.Reserve(capacity);
+        _ticks.Reserve(capacity);
+    }
+
+    // Packed access: Entities()[i] owns At(i) for i < Size().
+    size_t Size() const { return _entities.Size(); }
+    const Entity *Entities() const { return _entities.Data(); }
+    T &At(size_t index) { return _componentArray[index]; }
+    ComponentTicks &TicksAt(size_t index) { return _ticks[index]; }
+
+    ComponentTicks &GetTicks(Entity entity) {
+        assert(_entities.Contains(entity) && "Try to get ticks of non existence entity.");
+
+        return _ticks[_entities.Index(entity)];
+    }
+
+    size_t MemoryUsage() const override {
+        return _componentArray.MemoryUsage() + _ticks.MemoryUsage() + _entities.MemoryUsage();
+    }
 };
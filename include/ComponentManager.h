@@ -1,54 +1,98 @@
 #pragma once
 #include "Component.h"
 #include "ComponentArray.h"
+#include "TypeId.h"
+#include <array>
 #include <memory>
+#include <span>
+#include <vector>
 
 class ComponentManager {
   private:
-    std::unordered_map<std::string, ComponentType> _componentType{};
-    std::unordered_map<std::string, std::shared_ptr<IComponentArray>> _componentArrays{};
+    static constexpr ComponentType UNREGISTERED = MAX_COMPONENTS;
+
+    // Process-wide TypeId -> this manager's component type (signature bit)
+    std::vector<ComponentType> _componentType{};
+    // Owned here; arrays never move once registered, so the raw pointers handed out stay valid for the manager's lifetime
+    std::array<std::unique_ptr<IComponentArray>, MAX_COMPONENTS> _componentArrays{};
     ComponentType _nextComponentType{};
 
-    template <typename T> std::shared_ptr<ComponentArray<T>> GetComponentArray() {
-        const char *typeName = typeid(T).name();
+    template <typename T> ComponentType AssignComponentType() {
+        TypeId id = GetTypeId<T>();
 
-        assert(_componentType.find(typeName) != _componentType.end() && "Component not registered before use.");
+        if (id >= _componentType.size())
+            _componentType.resize(id + 1, UNREGISTERED);
+        assert(_componentType[id] == UNREGISTERED && "Registering component type more than once.");
+        assert(_nextComponentType < MAX_COMPONENTS && "Too many component types.");
+        _componentType[id] = _nextComponentType;
+        return _nextComponentType++;
+    }
 
-        return std::static_pointer_cast<ComponentArray<T>>(_componentArrays[typeName]);
+    template <typename T> ComponentArray<T> *Array() {
+        return static_cast<ComponentArray<T> *>(_componentArrays[GetComponentType<T>()].get());
     }
 
   public:
+    template <typename T> ComponentArray<T> *GetComponentArray() { return Array<T>(); }
+
     template <typename T> void RegisterComponent() {
-        const char *typeName = typeid(T).name();
-        assert(_componentType.find(typeName) == _componentType.end() && "Registering component type more than once.");
-        _componentType.insert({typeName, _nextComponentType});
-        _componentArrays.insert({typeName, std::make_shared<ComponentArray<T>>()});
-        _nextComponentType++;
+        ComponentType type = AssignComponentType<T>();
+        _componentArrays[type] = std::make_unique<ComponentArray<T>>();
     }
 
+    // Assigns a component type without allocating a ComponentArray, for storage backends that keep the data themselves.
+    template <typename T> void RegisterComponentType() { AssignComponentType<T>(); }
+
     template <typename T> ComponentType GetComponentType() {
-        const char *typeName = typeid(T).name();
-        assert(_componentType.find(typeName) != _componentType.end() && "Component not registered before use.");
-        return _componentType[typeName];
+        TypeId id = GetTypeId<T>();
+        assert(id < _componentType.size() && _componentType[id] != UNREGISTERED && "Component not registered before use.");
+        return _componentType[id];
+    }
+
+    template <typename T> void AddComponent(Entity entity, T component) { Array<T>()->InsertData(entity, component); }
+
+    // Type-erased batch add, `component` pointing to a component of the given type.
+    void AddComponent(ComponentType type, std::span<const Entity> entities, const void *component) {
+        assert(_componentArrays[type] && "Component not registered before use.");
+
+        _componentArrays[type]->InsertCopies(entities, component);
     }
 
-    template <typename T> void AddComponent(Entity entity, T component) { GetComponentArray<T>()->InsertData(entity, component); }
+    template <typename T> void RemoveComponent(Entity entity) { Array<T>()->RemoveData(entity); }
 
-    template <typename T> void RemoveComponent(Entity entity) { GetComponentArray<T>()->RemoveData(entity); }
+    template <typename T> T &GetComponent(Entity entity) { return Array<T>()->GetData(entity); }
 
-    template <typename T> T &GetComponent(Entity entity) { return GetComponentArray<T>()->GetData(entity); }
+    template <typename T> ComponentTicks &GetTicks(Entity entity) { return Array<T>()->GetTicks(entity); }
 
     template <typename T> bool HasComponent(Entity entity) {
-        auto array = GetComponentArray<T>();
+        auto array = Array<T>();
         if (!array)
             return false;
         return array->HasData(entity);
     }
 
-    void EntityDestroyed(Entity entity) {
-        for (auto const &pair : _componentArrays) {
-            auto const &component = pair.second;
-            component->EntityDestroyed(entity);
+    size_t MemoryUsage() const {
+        size_t bytes = 0;
+        for (ComponentType type = 0; type < _nextComponentType; type++) {
+            if (_componentArrays[type])
+                bytes += _componentArrays[type]->MemoryUsage();
+        }
+        return bytes;
+    }
+
+    // Only the arrays of the components in the entity's signature are touched.
+    void EntityDestroyed(Entity entity, Signature signature) {
+        for (ComponentType type = 0; type < _nextComponentType; type++) {
+            if (signature.test(type) && _componentArrays[type])
+                _componentArrays[type]->EntityDestroyed(entity);
+        }
+    }
+
+    // Drops every stored component; component types stay registered.
+    void Clear() {
+        for (ComponentType type = 0; type < _nextComponentType; type++) {
+            if (_componentArrays[type])
+                _componentArrays[type]->Clear();
         }
     }
 };
@@ -1,6 +1,5 @@
 #pragma once
+#include "EntityId.h"
 #include <cstdint>
 
 using Entity = std::uint32_t;
-
-const Entity MAX_ENTITIES = 10000;
@@ -0,0 +1,22 @@
+#pragma once
+#include <cstdint>
+
+// Entity handles are 32-bit values packing a slot index in the low
+// ENTITY_INDEX_BITS and the slot's generation in the remaining high bits.
+// The generation is bumped each time a slot is freed, so a handle kept after
+// its entity was destroyed no longer matches the entity reusing the slot.
+
+constexpr std::uint32_t ENTITY_INDEX_BITS = 20;
+constexpr std::uint32_t ENTITY_INDEX_MASK = (1u << ENTITY_INDEX_BITS) - 1;
+constexpr std::uint32_t ENTITY_GENERATION_MASK = (1u << (32 - ENTITY_INDEX_BITS)) - 1;
+
+// Never handed out: its index is one past the last usable slot.
+constexpr std::uint32_t NULL_ENTITY = UINT32_MAX;
+
+constexpr std::uint32_t EntityIndex(std::uint32_t entity) { return entity & ENTITY_INDEX_MASK; }
+
+constexpr std::uint32_t EntityGeneration(std::uint32_t entity) { return entity >> ENTITY_INDEX_BITS; }
+
+constexpr std::uint32_t MakeEntity(std::uint32_t index, std::uint32_t generation) {
+    return ((generation & ENTITY_GENERATION_MASK) << ENTITY_INDEX_BITS) | (index & ENTITY_INDEX_MASK);
+}
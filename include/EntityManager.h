@@ -1,48 +1,138 @@
 #pragma once
 #include "Signature.h"
 #include "Entity.h"
-#include <array>
+#include <algorithm>
 #include <cassert>
-#include <queue>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 class EntityManager {
   private:
-    std::queue<Entity> _entityAvailable{};
-    std::array<Signature, MAX_ENTITIES> _signatures{};
+    static constexpr uint32_t NO_FREE_SLOT = ENTITY_INDEX_MASK;
+
+    // One slot per entity index. A destroyed slot keeps its bumped generation and
+    // links to the next free slot, so the free list lives inside this array.
+    struct EntitySlot {
+        Signature signature;
+        Signature committed; // Signature the systems were last told about
+        uint32_t generation;
+        uint32_t nextFree;
+    };
+
+    std::vector<EntitySlot> _slots{};
+    uint32_t _freeHead = NO_FREE_SLOT;
     uint32_t _livingEntity{};
+    std::unordered_map<Entity, std::string> _entityToName{};
+    std::unordered_map<std::string, Entity> _nameToEntity{};
 
-  public:
-    EntityManager() {
-        for (Entity entity = 0; entity < MAX_ENTITIES; entity++)
-            _entityAvailable.push(entity);
+    EntitySlot &GetSlot(Entity entity) {
+        assert(IsAlive(entity) && "Entity is not alive.");
+
+        return _slots[EntityIndex(entity)];
     }
 
+  public:
+    // Throws std::length_error once ENTITY_INDEX_MASK entities are alive.
     Entity CreateEntity() {
-        assert(_livingEntity < MAX_ENTITIES && "Too many entities in existence.");
+        uint32_t index;
 
-        Entity id = _entityAvailable.front();
-        _entityAvailable.pop();
+        if (_freeHead != NO_FREE_SLOT) {
+            index = _freeHead;
+            _freeHead = _slots[index].nextFree;
+        } else {
+            // Checked in every build, an index past the mask would alias slot 0
+            if (_slots.size() >= NO_FREE_SLOT)
+                throw std::length_error("Too many entities in existence.");
+            index = static_cast<uint32_t>(_slots.size());
+            _slots.push_back(EntitySlot{Signature{}, Signature{}, 0, NO_FREE_SLOT});
+        }
+        _slots[index].nextFree = index;
         _livingEntity++;
-        return id;
+        return MakeEntity(index, _slots[index].generation);
+    }
+
+    // A name already in use moves to the new entity, the previous holder is left unnamed.
+    Entity CreateEntity(std::string name) {
+        Entity entity = CreateEntity();
+        auto previous = _nameToEntity.find(name);
+
+        if (previous != _nameToEntity.end())
+            _entityToName.erase(previous->second);
+        _entityToName[entity] = name;
+        _nameToEntity[std::move(name)] = entity;
+        return entity;
+    }
+
+    Entity FindEntity(const std::string &name) const {
+        auto it = _nameToEntity.find(name);
+
+        return it == _nameToEntity.end() ? NULL_ENTITY : it->second;
+    }
+
+    // Makes room for `count` more entities than are alive.
+    void Reserve(size_t count) {
+        size_t freeSlots = _slots.size() - _livingEntity;
+
+        if (count > freeSlots && _slots.size() + count - freeSlots > _slots.capacity())
+            _slots.reserve(std::max(_slots.size() + count - freeSlots, _slots.capacity() * 2));
     }
 
     void DestroyEntity(Entity entity) {
-        assert(entity < MAX_ENTITIES && "Entity out of range.");
+        EntitySlot &slot = GetSlot(entity);
 
-        _signatures[entity].reset();
-        _entityAvailable.push(entity);
+        slot.signature.reset();
+        slot.committed.reset();
+        slot.generation = (slot.generation + 1) & ENTITY_GENERATION_MASK;
+        slot.nextFree = _freeHead;
+        _freeHead = EntityIndex(entity);
         _livingEntity--;
+
+        if (!_entityToName.empty()) {
+            auto it = _entityToName.find(entity);
+            if (it != _entityToName.end()) {
+                auto named = _nameToEntity.find(it->second);
+                if (named != _nameToEntity.end() && named->second == entity)
+                    _nameToEntity.erase(named);
+                _entityToName.erase(it);
+            }
+        }
     }
 
-    void SetSignature(Entity entity, Signature signature) {
-        assert(entity < MAX_ENTITIES && "Entity out of range.");
+    // Frees every slot, bumping live generations so handles from before the clear stay invalid.
+    void Clear() {
+        _freeHead = NO_FREE_SLOT;
+        for (uint32_t index = static_cast<uint32_t>(_slots.size()); index-- > 0;) {
+            EntitySlot &slot = _slots[index];
 
-        _signatures[entity] = signature;
+            if (slot.nextFree == index)
+                slot.generation = (slot.generation + 1) & ENTITY_GENERATION_MASK;
+            slot.signature.reset();
+            slot.committed.reset();
+            slot.nextFree = _freeHead;
+            _freeHead = index;
+        }
+        _livingEntity = 0;
+        _entityToName.clear();
+        _nameToEntity.clear();
     }
 
-    Signature GetSignature(Entity entity) {
-        assert(entity < MAX_ENTITIES && "Entity out of range.");
+    // A slot is live when it links to itself instead of to the free list.
+    bool IsAlive(Entity entity) const {
+        uint32_t index = EntityIndex(entity);
 
-        return _signatures[entity];
+        return index < _slots.size() && _slots[index].nextFree == index &&
+               _slots[index].generation == EntityGeneration(entity);
     }
+
+    void SetSignature(Entity entity, Signature signature) { GetSlot(entity).signature = signature; }
+
+    Signature GetSignature(Entity entity) { return GetSlot(entity).signature; }
+
+    void SetCommittedSignature(Entity entity, Signature signature) { GetSlot(entity).committed = signature; }
+
+    Signature GetCommittedSignature(Entity entity) { return GetSlot(entity).committed; }
+
+    uint32_t GetLivingEntityCount() const { return _livingEntity; }
 };
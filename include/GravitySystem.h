@@ -8,12 +8,13 @@ extern Scene _core;
 class GravitySystem : public System {
     public:
         void Update() override {
-            for (auto const& entity: _entities) {
+            for (auto const& entity: Entities()) {
                 auto& pos = _core.GetComponent<Position>(entity);
                 auto& gravity = _core.GetComponent<Gravity>(entity);
                 pos.position.y += gravity.force;
                 if (pos.position.y >= 400)
                     pos.position.y = 400;
+                _core.MarkChanged<Position>(entity);
                 std::cout << "Gravity system" << std::endl;
             }
         }
@@ -25,10 +25,14 @@ typedef int socklen_t;
 #include <cstdint>
 #include <cstdio>
 #include <cstring>
+#include <span>
 #include <vector>
 
 namespace Roar {
 
+// Largest UDP payload over IPv4
+constexpr size_t MAX_DATAGRAM_SIZE = 65507;
+
 class INetBuffer {
   public:
     virtual ~INetBuffer() = default;
@@ -51,9 +55,19 @@ class INetBuffer {
     virtual size_t GetSize() const = 0;
     virtual size_t GetReadPos() const = 0;
     virtual bool CanRead(size_t bytes) const = 0;
+    virtual bool Overflowed() const = 0;
+    virtual size_t GetCapacity() const = 0;
+    // Takes the first `size` bytes of GetData() as the content, written there directly (e.g. by recvfrom)
+    virtual void SetSize(size_t size) = 0;
     virtual void LoadData(const uint8_t *data, size_t size) = 0;
 };
 
+// One datagram of a batch, with the address it goes to or came from
+struct NetPacket {
+    INetBuffer *buffer;
+    sockaddr_in address;
+};
+
 class INetSocket {
   public:
     virtual ~INetSocket() = default;
@@ -61,6 +75,10 @@ class INetSocket {
     virtual bool SendTo(const INetBuffer &buffer, const sockaddr_in &dest) = 0;
     virtual bool SendTo(const INetBuffer &buffer, const char *ip, uint16_t port) = 0;
     virtual int ReceiveFrom(INetBuffer &buffer, sockaddr_in &from) = 0;
+    // Fills the packets in order with the datagrams waiting, returns how many (0 when none) or -1 on error
+    virtual int ReceiveBatch(std::span<NetPacket> packets) = 0;
+    // Returns how many packets went out, the first ones, or -1 when none did because of an error
+    virtual int SendBatch(std::span<const NetPacket> packets) = 0;
     virtual SOCKET_TYPE GetFd() const = 0;
     virtual bool IsBound() const = 0;
 };
@@ -71,6 +89,8 @@ class INetServer {
     virtual bool Start() = 0;
     virtual int Receive(INetBuffer &buffer, sockaddr_in &from) = 0;
     virtual bool SendTo(const INetBuffer &buffer, const sockaddr_in &dest) = 0;
+    virtual int ReceiveBatch(std::span<NetPacket> packets) = 0;
+    virtual int SendBatch(std::span<const NetPacket> packets) = 0;
     virtual SOCKET_TYPE GetFd() const = 0;
 };
 
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "AssetManager.h"
+#include "EngineApi.h"
+#include "raylib.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace Roar {
+
+// One textured quad, as extracted from the scene. Commands sort on `key`.
+struct DrawCommand {
+    uint64_t key; // layer in the high 32 bits, texture handle in the low ones
+    Rectangle source;
+    Rectangle dest;
+    Color tint;
+
+    static uint64_t MakeKey(TextureHandle texture, uint16_t layer) { return (static_cast<uint64_t>(layer) << 32) | texture.id; }
+    TextureHandle Texture() const { return TextureHandle{static_cast<uint32_t>(key)}; }
+};
+
+// Where sorted draw commands end up. Each call gets a run of commands sharing one texture.
+class IRenderBackend {
+  public:
+    virtual ~IRenderBackend() = default;
+
+    virtual void DrawSprites(TextureHandle texture, std::span<const DrawCommand> commands) = 0;
+};
+
+// Draws through raylib, which merges a run into a single draw call. Main thread only.
+class ENGINE_API RaylibRenderBackend : public IRenderBackend {
+  public:
+    void DrawSprites(TextureHandle texture, std::span<const DrawCommand> commands) override;
+};
+
+// Draws nothing and counts what it was given, to run and benchmark rendering headless.
+class ENGINE_API NullRenderBackend : public IRenderBackend {
+  public:
+    size_t sprites = 0;
+    size_t batches = 0;
+
+    void DrawSprites(TextureHandle texture, std::span<const DrawCommand> commands) override;
+};
+
+} // namespace Roar
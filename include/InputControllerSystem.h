@@ -19,20 +19,13 @@
 
 extern Scene _core;
 
-void fire(Vector2& missilePos, Vector2& palyerPos, AnimationComponent& missileAnim)
-{
-    missilePos.x = palyerPos.x;
-    missilePos.y = palyerPos.y;
-    missileAnim.rect.x = missileAnim._animationRectangle[missileAnim._current_frame].x;
-    missileAnim.rect.y = missileAnim._animationRectangle[missileAnim._current_frame].y;
-    missileAnim.rect.height = missileAnim._animationRectangle[missileAnim._current_frame].height;
-    missileAnim.rect.width = missileAnim._animationRectangle[missileAnim._current_frame].width;
-}
-
 class InputControllerSystem : public System {
     public:
+        // Polls the keyboard
+        InputControllerSystem() { mainThread = true; }
+
         void Update() override {
-            for (auto& entity: _entities) {
+            for (auto entity: Entities()) {
                 auto& pos = _core.GetComponent<Position>(entity);
                 auto& input = _core.GetComponent<InputController>(entity);
                 auto& playertexture = _core.GetComponent<PlayerSprite>(entity);
@@ -42,11 +35,7 @@ class InputControllerSystem : public System {
                 velocity.speedY = 0;
                 if (IsKeyDown(KEY_SPACE) && !cooldown.canFire) {
                     cooldown.canFire = true;
-                    Entity missile = Prefab::MakeMilssile(_core);
-                    auto& missilePos = _core.GetComponent<Position>(missile);
-                    auto&  anim = _core.GetComponent<AnimationComponent>(missile);
-                    auto& sprite = _core.GetComponent<Sprite>(missile);
-                    fire(missilePos.position, pos.position, anim);
+                    Prefab::MakeMilssile(_core.Commands(), pos.position);
                 }
                 if (IsKeyUp(KEY_SPACE))
                     cooldown.canFire = false;
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "EngineApi.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Roar {
+
+// Pool of worker threads with one job deque each. A thread pushes and pops at
+// the back of its own deque; idle workers steal from the front of the others.
+// Threads outside the pool share deque 0.
+class ENGINE_API JobSystem {
+  public:
+    using Job = std::function<void()>;
+
+    explicit JobSystem(uint32_t workerCount = DefaultWorkerCount());
+    ~JobSystem();
+
+    JobSystem(const JobSystem &) = delete;
+    JobSystem &operator=(const JobSystem &) = delete;
+
+    void Submit(Job job);
+
+    // Calls func(begin, end) over [0, count) in chunks of `grain` items, 0 picking a
+    // size that gives each thread a few chunks. The caller runs chunks too and
+    // returns once all of them are done.
+    void ParallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)> &func);
+
+    // Runs one queued job on the calling thread, so a thread waiting on jobs can help instead of
+    // blocking (with no workers it is the only way they run). False if nothing was queued.
+    bool RunPending() { return TryRun(CurrentWorker()); }
+
+    uint32_t WorkerCount() const { return _workerCount; }
+
+    // 0 outside the pool (main thread), 1..WorkerCount() on a worker.
+    static uint32_t CurrentWorker();
+
+    // One worker per hardware thread, leaving one for the main thread.
+    static uint32_t DefaultWorkerCount();
+
+  private:
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+    };
+
+    // Fixed before any worker starts, the workers read it while _workers is still being filled
+    const uint32_t _workerCount;
+    std::vector<std::thread> _workers;
+    std::unique_ptr<WorkQueue[]> _queues;
+    std::atomic<size_t> _queued{0};
+    std::mutex _sleepMutex;
+    std::condition_variable _wake;
+    bool _stopping = false;
+
+    uint32_t QueueCount() const { return WorkerCount() + 1; }
+    void Push(uint32_t queue, Job job);
+    bool TryRun(uint32_t self);
+    void WorkerLoop(uint32_t worker);
+};
+
+// Engine-wide pool, started on first use.
+ENGINE_API JobSystem &Jobs();
+
+} // namespace Roar
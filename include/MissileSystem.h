@@ -27,16 +27,12 @@ void AnimMissile(Position& pos, AnimationComponent& anim) {
 class MissileSystem : public System {
     public:
         void Update() override {
-            for (auto& entity: _entities) {
-                auto& pos = _core.GetComponent<Position>(entity);
-                auto& anim = _core.GetComponent<AnimationComponent>(entity);
-                auto& tag = _core.GetComponent<MissileTag>(entity);
-                AnimMissile(pos, anim);
-                if (pos.position.x > GAME_WIDTH) {
-                    std::cout << "Destroying missile at x=" << pos.position.x << std::endl;
-                    _core.DestroyEntity(entity);
-                    break;
-                }
-            }
+            _core.View<Position, AnimationComponent, const MissileTag>().ParallelEach(
+                [](Entity entity, Position& pos, AnimationComponent& anim, const MissileTag&) {
+                    AnimMissile(pos, anim);
+                    // Every missile that left the screen this frame goes at the next flush
+                    if (pos.position.x > GAME_WIDTH)
+                        _core.Commands().DestroyEntity(entity);
+                });
         }
 };
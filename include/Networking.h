@@ -30,7 +30,11 @@ typedef int socklen_t;
 
 #include <cstdint>
 #include <cstdio>
+#include <algorithm>
+#include <atomic>
 #include <cstring>
+#include <memory>
+#include <mutex>
 #include <vector>
 
 namespace Roar {
@@ -41,49 +45,64 @@ class NetBuffer : public INetBuffer {
     size_t _size;
     size_t _capacity;
     size_t _readPos;
+    bool _overflowed; // a write did not fit and was dropped, the data is incomplete
 
   public:
-    NetBuffer(size_t capacity = 4096) : _size(0), _capacity(capacity), _readPos(0) { _data = new uint8_t[capacity]; }
+    NetBuffer(size_t capacity = 4096) : _size(0), _capacity(capacity), _readPos(0), _overflowed(false) {
+        _data = new uint8_t[capacity];
+    }
     ~NetBuffer() { delete[] _data; }
 
     // Write operations
     void WriteUInt8(uint8_t value) override {
-        if (_size + sizeof(uint8_t) > _capacity)
+        if (_size + sizeof(uint8_t) > _capacity) {
+            _overflowed = true;
             return;
+        }
         _data[_size++] = value;
     }
 
     void WriteUInt16(uint16_t value) override {
-        if (_size + sizeof(uint16_t) > _capacity)
+        if (_size + sizeof(uint16_t) > _capacity) {
+            _overflowed = true;
             return;
+        }
         memcpy(_data + _size, &value, sizeof(uint16_t));
         _size += sizeof(uint16_t);
     }
 
     void WriteUInt32(uint32_t value) override {
-        if (_size + sizeof(uint32_t) > _capacity)
+        if (_size + sizeof(uint32_t) > _capacity) {
+            _overflowed = true;
             return;
+        }
         memcpy(_data + _size, &value, sizeof(uint32_t));
         _size += sizeof(uint32_t);
     }
 
     void WriteInt32(int32_t value) override {
-        if (_size + sizeof(int32_t) > _capacity)
+        if (_size + sizeof(int32_t) > _capacity) {
+            _overflowed = true;
             return;
+        }
         memcpy(_data + _size, &value, sizeof(int32_t));
         _size += sizeof(int32_t);
     }
 
     void WriteFloat(float value) override {
-        if (_size + sizeof(float) > _capacity)
+        if (_size + sizeof(float) > _capacity) {
+            _overflowed = true;
             return;
+        }
         memcpy(_data + _size, &value, sizeof(float));
         _size += sizeof(float);
     }
 
     void WriteBytes(const void *data, size_t length) override {
-        if (_size + length > _capacity)
+        if (_size + length > _capacity) {
+            _overflowed = true;
             return;
+        }
         memcpy(_data + _size, data, length);
         _size += length;
     }
@@ -142,6 +161,7 @@ class NetBuffer : public INetBuffer {
     void Clear() override {
         _size = 0;
         _readPos = 0;
+        _overflowed = false;
     }
 
     void ResetRead() override { _readPos = 0; }
@@ -151,6 +171,14 @@ class NetBuffer : public INetBuffer {
     size_t GetSize() const override { return _size; }
     size_t GetReadPos() const override { return _readPos; }
     bool CanRead(size_t bytes) const override { return _readPos + bytes <= _size; }
+    bool Overflowed() const override { return _overflowed; }
+    size_t GetCapacity() const override { return _capacity; }
+
+    void SetSize(size_t size) override {
+        _size = size < _capacity ? size : _capacity;
+        _readPos = 0;
+        _overflowed = false;
+    }
 
     // Load data from external buffer
     void LoadData(const uint8_t *data, size_t size) override {
@@ -162,11 +190,90 @@ class NetBuffer : public INetBuffer {
     }
 };
 
+// NetBuffers allocated once and handed out again and again, so that sending and receiving never touch the
+// heap once the pool holds as many buffers as are in use at a time. Jobs may acquire buffers concurrently.
+class NetBufferPool {
+  private:
+    size_t _capacity;
+    std::vector<std::unique_ptr<NetBuffer>> _buffers;
+    std::vector<NetBuffer *> _free;
+    std::mutex _mutex;
+
+    void Release(NetBuffer *buffer) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _free.push_back(buffer);
+    }
+
+  public:
+    // Gives the buffer back to its pool when it goes out of scope
+    class Lease {
+      private:
+        NetBufferPool *_pool;
+        NetBuffer *_buffer;
+
+      public:
+        Lease(NetBufferPool *pool, NetBuffer *buffer) : _pool(pool), _buffer(buffer) {}
+        Lease(Lease &&other) noexcept : _pool(other._pool), _buffer(other._buffer) { other._buffer = nullptr; }
+        Lease &operator=(Lease &&) = delete;
+        ~Lease() {
+            if (_buffer)
+                _pool->Release(_buffer);
+        }
+
+        NetBuffer &operator*() const { return *_buffer; }
+        NetBuffer *operator->() const { return _buffer; }
+    };
+
+    explicit NetBufferPool(size_t capacity = MAX_DATAGRAM_SIZE, size_t count = 4) : _capacity(capacity) {
+        for (size_t i = 0; i < count; i++)
+            _buffers.push_back(std::make_unique<NetBuffer>(capacity));
+        for (auto &buffer : _buffers)
+            _free.push_back(buffer.get());
+    }
+
+    // An empty buffer, a new one when all of them are out
+    Lease Acquire() {
+        NetBuffer *buffer;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_free.empty()) {
+                _buffers.push_back(std::make_unique<NetBuffer>(_capacity));
+                // Releases never reallocate
+                _free.reserve(_buffers.size());
+                _free.push_back(_buffers.back().get());
+            }
+            buffer = _free.back();
+            _free.pop_back();
+        }
+        buffer->Clear();
+        return Lease(this, buffer);
+    }
+
+    // Buffers allocated so far
+    size_t Size() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _buffers.size();
+    }
+};
+
 class NetSocket : public INetSocket {
+  public:
+    // Datagrams a single recvmmsg/sendmmsg call moves at most
+    static constexpr size_t MAX_BATCH = 64;
+
   private:
     SOCKET_TYPE _sockfd;
     sockaddr_in _addr;
     bool _bound;
+    std::atomic<size_t> _syscalls{0}; // socket I/O calls, sends may come from several jobs
+
+    static bool WouldBlock() {
+#if defined(_WIN32) || defined(_WIN64)
+        return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+        return errno == EAGAIN || errno == EWOULDBLOCK;
+#endif
+    }
 
   public:
     NetSocket() : _sockfd(INVALID_SOCK), _bound(false) {
@@ -218,6 +325,7 @@ class NetSocket : public INetSocket {
     }
 
     bool SendTo(const INetBuffer &buffer, const sockaddr_in &dest) override {
+        _syscalls.fetch_add(1, std::memory_order_relaxed);
         int sent =
             sendto(_sockfd, (const char *)buffer.GetData(), (int)buffer.GetSize(), 0, (struct sockaddr *)&dest, sizeof(dest));
         return sent > 0;
@@ -233,20 +341,103 @@ class NetSocket : public INetSocket {
         return SendTo(buffer, dest);
     }
 
+    // Straight into the buffer, parsed from there. A datagram longer than its capacity is truncated.
     int ReceiveFrom(INetBuffer &buffer, sockaddr_in &from) override {
-        char temp[4096];
         socklen_t fromLen = sizeof(from);
 
-        int received = recvfrom(_sockfd, temp, sizeof(temp), 0, (struct sockaddr *)&from, &fromLen);
+        _syscalls.fetch_add(1, std::memory_order_relaxed);
+        int received = recvfrom(_sockfd, (char *)buffer.GetData(), (int)buffer.GetCapacity(), 0, (struct sockaddr *)&from,
+                                &fromLen);
 
         if (received > 0) {
-            buffer.LoadData((const uint8_t *)temp, received);
+            buffer.SetSize(received);
             return received;
         }
 
         return received; // 0 or -1
     }
 
+#if defined(__linux__)
+    // One recvmmsg call for up to MAX_BATCH datagrams
+    int ReceiveBatch(std::span<NetPacket> packets) override {
+        mmsghdr messages[MAX_BATCH];
+        iovec vectors[MAX_BATCH];
+        size_t count = std::min(packets.size(), MAX_BATCH);
+
+        for (size_t i = 0; i < count; i++) {
+            vectors[i] = iovec{packets[i].buffer->GetData(), packets[i].buffer->GetCapacity()};
+            memset(&messages[i], 0, sizeof(mmsghdr));
+            messages[i].msg_hdr.msg_name = &packets[i].address;
+            messages[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+            messages[i].msg_hdr.msg_iov = &vectors[i];
+            messages[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        _syscalls.fetch_add(1, std::memory_order_relaxed);
+        int received = recvmmsg(_sockfd, messages, (unsigned int)count, 0, nullptr);
+        if (received < 0)
+            return WouldBlock() ? 0 : -1;
+
+        for (int i = 0; i < received; i++)
+            packets[i].buffer->SetSize(messages[i].msg_len);
+        return received;
+    }
+
+    // sendmmsg calls of up to MAX_BATCH datagrams, until every packet went out or the socket refuses more
+    int SendBatch(std::span<const NetPacket> packets) override {
+        mmsghdr messages[MAX_BATCH];
+        iovec vectors[MAX_BATCH];
+        size_t sent = 0;
+
+        while (sent < packets.size()) {
+            size_t count = std::min(packets.size() - sent, MAX_BATCH);
+
+            for (size_t i = 0; i < count; i++) {
+                const NetPacket &packet = packets[sent + i];
+
+                vectors[i] = iovec{(void *)packet.buffer->GetData(), packet.buffer->GetSize()};
+                memset(&messages[i], 0, sizeof(mmsghdr));
+                messages[i].msg_hdr.msg_name = (void *)&packet.address;
+                messages[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+                messages[i].msg_hdr.msg_iov = &vectors[i];
+                messages[i].msg_hdr.msg_iovlen = 1;
+            }
+
+            _syscalls.fetch_add(1, std::memory_order_relaxed);
+            int result = sendmmsg(_sockfd, messages, (unsigned int)count, 0);
+            if (result <= 0)
+                return sent > 0 ? (int)sent : -1;
+            sent += result;
+        }
+        return (int)sent;
+    }
+#else
+    // One ReceiveFrom() per datagram where recvmmsg does not exist
+    int ReceiveBatch(std::span<NetPacket> packets) override {
+        int received = 0;
+
+        for (NetPacket &packet : packets) {
+            if (ReceiveFrom(*packet.buffer, packet.address) <= 0)
+                return received > 0 || WouldBlock() ? received : -1;
+            received++;
+        }
+        return received;
+    }
+
+    int SendBatch(std::span<const NetPacket> packets) override {
+        int sent = 0;
+
+        for (const NetPacket &packet : packets) {
+            if (!SendTo(*packet.buffer, packet.address))
+                return sent > 0 ? sent : -1;
+            sent++;
+        }
+        return sent;
+    }
+#endif
+
+    size_t GetSyscallCount() const { return _syscalls.load(std::memory_order_relaxed); }
+
     SOCKET_TYPE GetFd() const override { return _sockfd; }
     bool IsBound() const override { return _bound; }
 };
@@ -261,6 +452,9 @@ class NetServer : public INetServer {
     bool Start() override { return _socket.Bind(_port); }
     int Receive(INetBuffer &buffer, sockaddr_in &from) override { return _socket.ReceiveFrom(buffer, from); }
     bool SendTo(const INetBuffer &buffer, const sockaddr_in &dest) override { return _socket.SendTo(buffer, dest); }
+    int ReceiveBatch(std::span<NetPacket> packets) override { return _socket.ReceiveBatch(packets); }
+    int SendBatch(std::span<const NetPacket> packets) override { return _socket.SendBatch(packets); }
+    size_t GetSyscallCount() const { return _socket.GetSyscallCount(); }
     SOCKET_TYPE GetFd() const override { return _socket.GetFd(); }
 };
 
@@ -0,0 +1,58 @@
+#pragma once
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Growable array stored in fixed-size pages.
+// Pages are allocated as elements are pushed and released as they are popped,
+// so memory follows the live element count. Elements never move when the
+// array grows: references stay valid until the element itself is popped.
+// Iteration is contiguous within a page.
+template <typename T, size_t PageSize = 1024> class PagedArray {
+    static_assert((PageSize & (PageSize - 1)) == 0, "PagedArray page size must be a power of two.");
+
+  private:
+    std::vector<std::unique_ptr<T[]>> _pages;
+    size_t _size = 0;
+
+    void AddPage() { _pages.push_back(std::make_unique<T[]>(PageSize)); }
+
+  public:
+    static constexpr size_t PAGE_SIZE = PageSize;
+
+    T &operator[](size_t index) { return _pages[index / PageSize][index % PageSize]; }
+    const T &operator[](size_t index) const { return _pages[index / PageSize][index % PageSize]; }
+
+    void PushBack(const T &value) {
+        if (_size == _pages.size() * PageSize)
+            AddPage();
+        (*this)[_size++] = value;
+    }
+
+    void PopBack() {
+        assert(_size > 0 && "PopBack on empty PagedArray.");
+
+        _size--;
+        // Keep one spare page so an add/remove cycle at a page boundary does not reallocate
+        if (_pages.size() * PageSize >= _size + 2 * PageSize)
+            _pages.pop_back();
+    }
+
+    T &Back() { return (*this)[_size - 1]; }
+
+    void Reserve(size_t capacity) {
+        while (_pages.size() * PageSize < capacity)
+            AddPage();
+    }
+
+    void Clear() {
+        _pages.clear();
+        _size = 0;
+    }
+
+    size_t Size() const { return _size; }
+    size_t PageCount() const { return _pages.size(); }
+    T *Page(size_t page) { return _pages[page].get(); }
+    size_t MemoryUsage() const { return _pages.size() * PageSize * sizeof(T); }
+};
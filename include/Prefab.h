@@ -1,38 +1,52 @@
 #pragma once
     #include "Scene.h"
+    #include "TextureAtlas.h"
 
 namespace Prefab {
-    Entity MakePlayer(Scene& _core, float posX, float posY);
-    Entity MakeEnemy(Scene& _core, float posX, float posY);
+    // The r-type sprite sheets packed into one atlas, built on first call. That call must come
+    // from the main thread; the templates make it. The atlas holds the only reference on its pages,
+    // released at exit.
+    const Roar::TextureAtlas& SpriteAtlas();
+
+    // Built once per scene, after its components are registered. The sprite texture is borrowed from
+    // SpriteAtlas() and shared by every instance, templates hold no reference on it.
+    PrefabTemplate PlayerTemplate(Scene& _core);
+    PrefabTemplate EnemyTemplate(Scene& _core);
+
+    Entity MakePlayer(Scene& _core, const PrefabTemplate& player, float posX, float posY);
+    Entity MakeEnemy(Scene& _core, const PrefabTemplate& enemy, float posX, float posY);
     Entity MakeMilssile(Scene& _core);
+    // Recorded into a command buffer, spawned at the next Scene::FlushCommands()
+    CommandBuffer::PendingEntity MakeMilssile(CommandBuffer& commands, Vector2 position);
     Entity MakeCamera(Scene& _core);
 
-    inline Entity MakeClient(Scene& _core, float x, float y, uint32_t client_id, bool is_local, Texture2D& playerTexture) {
+    inline Entity MakeClient(Scene& _core, float x, float y, uint32_t client_id, bool is_local, Roar::TextureHandle playerTexture) {
         Entity e = _core.CreateEntity();
         
         PlayerSprite sprite;
         sprite.texture = playerTexture;
         
-        _core.AddComponent(e, Position{Vector2{x, y}});
-        _core.AddComponent(e, sprite);
-        _core.AddComponent(e, AnimationComponent{
+        _core.AddComponentDeferred(e, Position{Vector2{x, y}});
+        _core.AddComponentDeferred(e, sprite);
+        _core.AddComponentDeferred(e, AnimationComponent{
             Rectangle{0, 30, 32, 22},
             {},
             0,
             0,
             8,
         });
-        _core.AddComponent(e, Tag{true});
-        _core.AddComponent(e, Sprite{WHITE});
-        _core.AddComponent(e, NetworkedClient{client_id, is_local});
+        _core.AddComponentDeferred(e, Tag{true});
+        _core.AddComponentDeferred(e, Sprite{WHITE, playerTexture, LAYER_PLAYERS});
+        _core.AddComponentDeferred(e, NetworkedClient{client_id, is_local});
         
         if (is_local) {
-            _core.AddComponent(e, InputController{});
-            _core.AddComponent(e, playerCooldown{false});
-            _core.AddComponent(e, LocalPlayerTag{});
+            _core.AddComponentDeferred(e, InputController{});
+            _core.AddComponentDeferred(e, playerCooldown{false});
+            _core.AddComponentDeferred(e, LocalPlayerTag{});
         } else {
-            _core.AddComponent(e, RemotePlayerTag{});
+            _core.AddComponentDeferred(e, RemotePlayerTag{});
         }
+        _core.CommitSignature(e);
         
         return e;
     }
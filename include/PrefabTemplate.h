@@ -0,0 +1,49 @@
+#pragma once
+#include "Component.h"
+#include "Signature.h"
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+// A set of components compiled once into a signature and a packed blob, then
+// copied into storage by Scene::Instantiate() with a single membership update.
+// Component types are the ones of the scene that built the template
+// (Scene::MakePrefab), so a template only fits that scene.
+// Resources such as textures are captured by handle and shared by every instance.
+class PrefabTemplate {
+  private:
+    Signature _signature;
+    std::vector<std::byte> _data;
+    std::array<size_t, MAX_COMPONENTS> _offsets{}; // component type -> offset in _data
+
+  public:
+    // Adds the component, or replaces the template's one of the same type.
+    template <typename T> PrefabTemplate &Set(ComponentType type, const T &component) {
+        static_assert(std::is_trivially_copyable_v<T>, "Prefab components must be trivially copyable.");
+        static_assert(alignof(T) <= alignof(std::max_align_t), "Prefab components must not be over-aligned.");
+
+        if (!_signature.test(type)) {
+            _offsets[type] = (_data.size() + alignof(T) - 1) / alignof(T) * alignof(T);
+            _data.resize(_offsets[type] + sizeof(T));
+            _signature.set(type, true);
+        }
+        std::memcpy(_data.data() + _offsets[type], &component, sizeof(T));
+        return *this;
+    }
+
+    Signature GetSignature() const { return _signature; }
+
+    // Component type -> pointer into the blob, null for types the template does not have.
+    std::array<const void *, MAX_COMPONENTS> Components() const {
+        std::array<const void *, MAX_COMPONENTS> components{};
+
+        for (ComponentType type = 0; type < MAX_COMPONENTS; type++) {
+            if (_signature.test(type))
+                components[type] = _data.data() + _offsets[type];
+        }
+        return components;
+    }
+};
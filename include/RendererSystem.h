@@ -1,67 +1,108 @@
 #pragma once
 #include "Scene.h"
+#include "SpatialGrid.h"
+#include "SpriteBatch.h"
 #include <raylib.h>
 
 extern Scene _core;
 
-// class PlayerRender
+// World space rectangle covered by a sprite, before any camera.
+inline Rectangle SpriteBounds(const Position &pos, const AnimationComponent &anim) {
+    return Rectangle{pos.position.x, pos.position.y, anim.rect.width * 2.0f, anim.rect.height * 2.0f};
+}
 
-class RendererSystem : public System {
-  private:
-    Texture2D texture;
-    Rectangle sourcerec;
-    Rectangle destrec;
-    Rectangle rec;
-    Vector2 origin = {0.0f, 0.0f};
+// Screen space placement of a sprite, seen through `cam` when there is one.
+inline Rectangle SpriteDestination(const Position &pos, const AnimationComponent &anim, const CameraComponent *cam) {
+    Rectangle bounds = SpriteBounds(pos, anim);
 
-  public:
-    CameraComponent *GetMainCamera() {
-        for (auto const &entity : _entities) {
-            if (!_core.HasComponent<CameraComponent>(entity))
-                continue;
-            auto &cam = _core.GetComponent<CameraComponent>(entity);
-            if (cam.mainCamera)
-                return &cam;
-        }
-        return nullptr;
-    };
+    if (!cam)
+        return bounds;
+    return Rectangle{cam->offset.x + (bounds.x - cam->position.x) * cam->zoom, cam->offset.y + (bounds.y - cam->position.y) * cam->zoom,
+                     bounds.width * cam->zoom, bounds.height * cam->zoom};
+}
 
-    void Update() override {
+// World space rectangle shown on a `screen` sized viewport, seen through `cam` when there is one.
+inline Rectangle VisibleArea(Rectangle screen, const CameraComponent *cam) {
+    if (!cam)
+        return screen;
+    return Rectangle{cam->position.x + (screen.x - cam->offset.x) / cam->zoom, cam->position.y + (screen.y - cam->offset.y) / cam->zoom,
+                     screen.width / cam->zoom, screen.height / cam->zoom};
+}
 
-        BeginDrawing();
-        ClearBackground(LIGHTGRAY);
-        CameraComponent *cam = nullptr;
-        DrawText("OUI oui", 10, 10, 20, BLACK);
+inline const CameraComponent *MainCamera(Scene &scene) {
+    const CameraComponent *cam = nullptr;
 
-        for (auto const &entity : _entities) {
-            auto &pos = _core.GetComponent<Position>(entity);
-            auto &sprite = _core.GetComponent<Sprite>(entity);
-            auto &anim = _core.GetComponent<AnimationComponent>(entity);
-            auto &tag = _core.GetComponent<Tag>(entity);
+    scene.View<const CameraComponent>().Each([&](const CameraComponent &camera) {
+        if (camera.mainCamera)
+            cam = &camera;
+    });
+    return cam;
+}
 
-            if (_core.HasComponent<PlayerSprite>(entity)) {
-                auto &playerTexture = _core.GetComponent<PlayerSprite>(entity);
-                texture = playerTexture.texture;
-            }
+// Walks every sprite of `scene` once into `batch`, without touching the GPU.
+inline void ExtractSprites(Scene &scene, Roar::SpriteBatch &batch) {
+    const CameraComponent *cam = MainCamera(scene);
 
-            sourcerec = {anim.rect.x, anim.rect.y, anim.rect.width, anim.rect.height};
-            if (_core.HasComponent<CameraComponent>(entity))
-                cam = GetMainCamera();
+    scene.View<const Position, const Sprite, const AnimationComponent>().Each(
+        [&](const Position &pos, const Sprite &sprite, const AnimationComponent &anim) {
+            batch.Draw(sprite.texture, sprite.layer, anim.rect, SpriteDestination(pos, anim, cam), sprite.color);
+        });
+}
 
-            Vector2 screenPos = pos.position;
+// Brings `grid` up to date with the sprites that appeared, moved, changed frame or went away since
+// the calling system last ran.
+inline void IndexSprites(Scene &scene, SpatialGrid &grid) {
+    auto remove = [&](Entity entity) { grid.Remove(entity); };
+    auto set = [&](Entity entity, const Position &pos, const Sprite &, const AnimationComponent &anim) {
+        grid.Set(entity, SpriteBounds(pos, anim));
+    };
 
-            if (cam) {
-                screenPos.x = cam->offset.x + (pos.position.x - cam->position.x) * cam->zoom;
-                screenPos.y = cam->offset.y + (pos.position.y - cam->position.y) * cam->zoom;
-            }
+    // Removals first, a component removed then added back in between is set again below
+    scene.Removed<Position>(remove);
+    scene.Removed<Sprite>(remove);
+    scene.Removed<AnimationComponent>(remove);
+    scene.View<const Position, const Sprite, const AnimationComponent>().Changed<Position>().Each(set);
+    scene.View<const Position, const Sprite, const AnimationComponent>().Changed<AnimationComponent>().Each(set);
+    scene.View<const Position, const Sprite, const AnimationComponent>().Added<Sprite>().Each(set);
+}
 
-            float scale = cam ? cam->zoom : 1.0f;
+// Same as ExtractSprites() for the sprites of `grid` inside the area the main camera shows on `screen`.
+inline void ExtractVisibleSprites(Scene &scene, const SpatialGrid &grid, Rectangle screen, Roar::SpriteBatch &batch) {
+    const CameraComponent *cam = MainCamera(scene);
 
-            destrec = {screenPos.x, screenPos.y, anim.rect.width * 2.0f * scale, anim.rect.height * 2.0f * scale};
+    grid.Query(VisibleArea(screen, cam), [&](Entity entity, const Rectangle &) {
+        const Sprite &sprite = scene.GetComponent<Sprite>(entity);
+        const AnimationComponent &anim = scene.GetComponent<AnimationComponent>(entity);
 
-            DrawTexturePro(texture, sourcerec, destrec, origin, 0.0f, sprite.color);
-        }
+        batch.Draw(sprite.texture, sprite.layer, anim.rect, SpriteDestination(scene.GetComponent<Position>(entity), anim, cam),
+                   sprite.color);
+    });
+}
 
-        EndDrawing();
+// Extracts the frame's visible sprites into draw commands during the system update, which may run on
+// a worker since it only reads components. Submit() then draws them on the main thread, inside the
+// BeginDrawing()/EndDrawing() pair of the frame.
+class RendererSystem : public System {
+  private:
+    Roar::SpriteBatch batch;
+    // Sprite bounds in world space, so off-screen sprites cost nothing to draw
+    SpatialGrid grid;
+    Rectangle screen{0.0f, 0.0f, GAME_WIDTH, GAME_HEIGHT};
+
+  public:
+    void SetScreenSize(float width, float height) { screen = Rectangle{0.0f, 0.0f, width, height}; }
+
+    void Update() override {
+        IndexSprites(_core, grid);
+        ExtractVisibleSprites(_core, grid, screen, batch);
     }
+
+    // Scene::Clear() records no removals, the grid would keep listing dead entities
+    void OnClear() override { grid.Clear(); }
+
+    // Sorted by layer and atlas page, thousands of missiles draw in a few batches
+    void Submit(Roar::IRenderBackend &backend) { batch.Flush(backend); }
+    void Submit() { batch.Flush(); }
+
+    const Roar::SpriteBatchStats &GetBatchStats() const { return batch.GetStats(); }
 };
@@ -1,10 +1,15 @@
 #pragma once
 
+#include "EngineApi.h"
 #include "framework.h"
 #include "raylib.h"
 
+#include "AssetManager.h"
+#include "BitStream.h"
 #include "Networking.h"
 #include "PluginManager.h"
+#include "SpriteBatch.h"
+#include "TextureAtlas.h"
 
 #include "spdlog/spdlog.h"
 
@@ -18,16 +23,6 @@
 #define RO_LOG_DEBUG(...) spdlog::debug(__VA_ARGS__)
 #define RO_ASSERT(_EXPR) assert(_EXPR)
 
-#if defined(_WIN32)
-#if defined(ENGINE_EXPORTS)
-#define ENGINE_API __declspec(dllexport)
-#else
-#define ENGINE_API __declspec(dllimport)
-#endif
-#else
-#define ENGINE_API __attribute__((visibility("default")))
-#endif
-
 namespace Roar {
 
 typedef struct AppData {
@@ -35,12 +30,37 @@ typedef struct AppData {
     uint32_t width = 1280;
     uint32_t height = 720;
     bool headless = false;
+    double assetUploadMs = 2.0; // per frame budget for uploading textures loaded asynchronously
     void (*init)();
     void (*frame)();
     void (*cleanup)();
+
+    // Headless only. With a tick rate, frame() runs at absolute deadlines that do not drift with the time
+    // frames take. In between the loop sleeps, and on Linux calls event() as soon as the fd returned by
+    // eventFd() turns readable, so packets do not wait for the next tick.
+    uint32_t tickRate = 0;              // 0 runs frame() back to back
+    SOCKET_TYPE (*eventFd)() = nullptr; // asked once, after init()
+    void (*event)() = nullptr;          // must drain the fd, it is watched level triggered
+    double tickReportSeconds = 60.0;    // between tick jitter reports in the log, 0 for none
 } AppData;
 
+// How late fixed rate ticks started after their deadline
+struct TickStats {
+    static constexpr int BUCKETS = 8;
+    // Upper bounds of the histogram buckets in microseconds, the last bucket takes the rest
+    static constexpr double BUCKET_LIMITS_US[BUCKETS - 1] = {50, 100, 250, 500, 1000, 2000, 5000};
+
+    uint64_t histogram[BUCKETS] = {};
+    uint64_t ticks = 0;
+    uint64_t events = 0;  // event() calls between ticks
+    uint64_t resyncs = 0; // times the schedule fell too far behind and started over from now
+    double maxLateUs = 0.0;
+    double totalLateUs = 0.0;
+};
+
 void AppRun(AppData appdata);
 void StopApp();
+// Of the headless tick loop of the running app
+ENGINE_API const TickStats &GetTickStats();
 
 } // namespace Roar
@@ -1,72 +1,271 @@
 #pragma once
 
+#include "Archetype.h"
+#include "ChangeTick.h"
+#include "CommandBuffer.h"
 #include "ComponentManager.h"
 #include "EntityManager.h"
+#include "PrefabTemplate.h"
 #include "SystemManager.h"
+#include "View.h"
+#include <array>
+#include <cstring>
 #include <iostream>
+#include <new>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <typeinfo>
 
-class Scene {
+// Where component data lives.
+// SparseSet keeps one packed ComponentArray per type, Archetype packs entities
+// of identical signature together in 16 KB chunks (see Archetype.h).
+enum class StorageBackend { SparseSet, Archetype };
+
+class ECS_API Scene {
   private:
     std::unique_ptr<EntityManager> _entityManager;
     std::unique_ptr<ComponentManager> _componentManager;
     std::unique_ptr<SystemManager> _systemManager;
+    std::unique_ptr<ArchetypeStorage> _archetypes;
+    // One per job pool thread, indexed by Roar::JobSystem::CurrentWorker()
+    std::vector<std::unique_ptr<CommandBuffer>> _commandBuffers;
+
+    struct Removal {
+        Entity entity;
+        Tick tick;
+    };
+
+    // Component type -> entities that lost it, kept until every system has run since
+    std::array<std::vector<Removal>, MAX_COMPONENTS> _removed;
+
+    // Destroys the entity everywhere but in the systems, returns the signature they know it by.
+    Signature ReleaseEntity(Entity entity);
+
+    void RecordRemoval(Entity entity, ComponentType type) { _removed[type].push_back(Removal{entity, ChangeTicks::Now()}); }
 
   public:
-    void Init() {
-        _entityManager = std::make_unique<EntityManager>();
-        _componentManager = std::make_unique<ComponentManager>();
-        _systemManager = std::make_unique<SystemManager>();
-    }
+    void Init(StorageBackend backend = StorageBackend::SparseSet);
+
+    // Destroys every entity and drops pending commands; registered components and systems are kept.
+    // No removal is recorded, systems hear of it through System::OnClear().
+    void Clear();
 
     //------ENTITY METHODS--------
     Entity CreateEntity() { return _entityManager->CreateEntity(); }
 
-    void DestroyEntity(Entity entity) {
-        _entityManager->DestroyEntity(entity);
-        _componentManager->EntityDestroyed(entity);
-        _systemManager->EntityDestroyed(entity);
-        std::cout << "entity bien destroy" << std::endl;
+    Entity CreateEntity(std::string name) { return _entityManager->CreateEntity(std::move(name)); }
+
+    // NULL_ENTITY if no live entity has that name.
+    Entity FindEntity(const std::string &name) const { return _entityManager->FindEntity(name); }
+
+    // False once the entity was destroyed, even if its index has been reused since.
+    bool IsAlive(Entity entity) const { return _entityManager->IsAlive(entity); }
+
+    void DestroyEntity(Entity entity);
+
+    // Creates `count` entities that each get a copy of the components, with one storage
+    // reservation and one system membership update for the whole batch.
+    template <typename... Ts> std::vector<Entity> CreateEntities(size_t count, Ts... components) {
+        Signature signature;
+        std::array<const void *, MAX_COMPONENTS> data{};
+        ((signature.set(_componentManager->GetComponentType<Ts>(), true),
+          data[_componentManager->GetComponentType<Ts>()] = &components),
+         ...);
+
+        std::vector<Entity> entities(count);
+        CreateEntitiesFrom(entities, signature, data);
+        return entities;
+    }
+
+    // Type-erased form of CreateEntities(): fills `entities` with new entities owning the components of
+    // `signature`, each one a copy of components[type].
+    void CreateEntitiesFrom(std::span<Entity> entities, Signature signature,
+                            const std::array<const void *, MAX_COMPONENTS> &components);
+
+    // Creates an entity from a prefab; `overrides` replace the prefab's components of the same type.
+    template <typename... Ts> Entity Instantiate(const PrefabTemplate &prefab, Ts... overrides) {
+        std::array<const void *, MAX_COMPONENTS> components = prefab.Components();
+        ((assert(prefab.GetSignature().test(_componentManager->GetComponentType<Ts>()) &&
+                 "Override of a component the prefab does not have."),
+          components[_componentManager->GetComponentType<Ts>()] = &overrides),
+         ...);
+
+        Entity entity;
+        CreateEntitiesFrom(std::span<Entity>(&entity, 1), prefab.GetSignature(), components);
+        return entity;
     }
 
-    void printSignature(Entity entity) {
-        Signature sig = _entityManager->GetSignature(entity);
+    // `count` identical copies of the prefab.
+    std::vector<Entity> InstantiateBatch(const PrefabTemplate &prefab, size_t count) {
+        std::vector<Entity> entities(count);
 
-        std::cout << "Signature => " << sig << std::endl;
+        CreateEntitiesFrom(entities, prefab.GetSignature(), prefab.Components());
+        return entities;
     }
 
+    // Compiles components into a prefab for this scene.
+    template <typename... Ts> PrefabTemplate MakePrefab(Ts... components) {
+        PrefabTemplate prefab;
+
+        (prefab.Set(_componentManager->GetComponentType<Ts>(), components), ...);
+        return prefab;
+    }
+
+    // Destroys live, distinct entities; entities sharing a signature leave their systems in one update.
+    void DestroyEntities(std::span<const Entity> entities);
+
+    Signature EntityGetSignature(Entity entity) { return _entityManager->GetSignature(entity); }
+
+    void printSignature(Entity entity);
+
     //------- COMPOENET METHODS ----------
-    template <typename T> void RegisterComponent() { _componentManager->RegisterComponent<T>(); }
+    // Throws std::logic_error for a type the archetype backend cannot store, in every build.
+    template <typename T> void RegisterComponent() {
+        if (!_archetypes) {
+            _componentManager->RegisterComponent<T>();
+            return;
+        }
 
-    template <typename T> void AddComponent(Entity entity, T component) {
-        _componentManager->AddComponent<T>(entity, component);
+        // Archetype chunks move components with memcpy
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            _componentManager->RegisterComponentType<T>();
+            _archetypes->RegisterComponent(_componentManager->GetComponentType<T>(), sizeof(T));
+        } else {
+            throw std::logic_error(std::string("Archetype storage requires trivially copyable components: ") + typeid(T).name());
+        }
+    }
+
+    // Stores the component but leaves system membership untouched until CommitSignature().
+    template <typename T> void AddComponentDeferred(Entity entity, T component) {
+        if (_archetypes)
+            _archetypes->Add(entity, _componentManager->GetComponentType<T>(), &component);
+        else
+            _componentManager->AddComponent<T>(entity, component);
 
         auto signature = _entityManager->GetSignature(entity);
         signature.set(_componentManager->GetComponentType<T>(), true);
         _entityManager->SetSignature(entity, signature);
-
-        _systemManager->EntitySignatureChanged(entity, signature);
     }
 
-    template <typename T> void RemoveComponent(Entity entity) {
-        _componentManager->RemoveComponent<T>(entity);
+    template <typename T> void RemoveComponentDeferred(Entity entity) {
+        RecordRemoval(entity, _componentManager->GetComponentType<T>());
+        if (_archetypes)
+            _archetypes->Remove(entity, _componentManager->GetComponentType<T>());
+        else
+            _componentManager->RemoveComponent<T>(entity);
 
         auto signature = _entityManager->GetSignature(entity);
         signature.set(_componentManager->GetComponentType<T>(), false);
         _entityManager->SetSignature(entity, signature);
+    }
 
-        _systemManager->EntitySignatureChanged(entity, signature);
+    // Publishes every component added or removed since the last commit to the systems at once.
+    void CommitSignature(Entity entity);
+
+    template <typename T> void AddComponent(Entity entity, T component) {
+        AddComponentDeferred<T>(entity, component);
+        CommitSignature(entity);
+    }
+
+    // Adds several components with a single system membership update.
+    template <typename... Ts> void AddComponents(Entity entity, Ts... components) {
+        (AddComponentDeferred<Ts>(entity, components), ...);
+        CommitSignature(entity);
+    }
+
+    template <typename T> void RemoveComponent(Entity entity) {
+        RemoveComponentDeferred<T>(entity);
+        CommitSignature(entity);
     }
 
-    template <typename T> T &GetComponent(Entity entity) { return _componentManager->GetComponent<T>(entity); }
+    template <typename T> T &GetComponent(Entity entity) {
+        if (_archetypes)
+            return *static_cast<T *>(_archetypes->Get(entity, _componentManager->GetComponentType<T>()));
+        return _componentManager->GetComponent<T>(entity);
+    }
+
+    // Stamps T as written by the caller, for writes that do not go through a mutable view.
+    template <typename T> void MarkChanged(Entity entity) {
+        ComponentTicks &ticks = _archetypes ? _archetypes->GetTicks(entity, _componentManager->GetComponentType<T>())
+                                            : _componentManager->GetTicks<T>(entity);
+
+        ticks.changed = ChangeTicks::Now();
+    }
+
+    // Calls func(entity) for every entity that lost T after `since`, destroyed ones included.
+    // By default since the previous run of the calling system (everything still recorded outside of a system).
+    template <typename T, typename Func> void Removed(Func &&func, Tick since = ChangeTicks::LastRun()) {
+        for (const Removal &removal : _removed[_componentManager->GetComponentType<T>()]) {
+            if (removal.tick > since)
+                func(removal.entity);
+        }
+    }
 
     template <typename T> ComponentType GetComponentType() { return _componentManager->GetComponentType<T>(); }
 
-    template <typename T> bool HasComponent(Entity entity) { return _componentManager->HasComponent<T>(entity); }
+    template <typename T> bool HasComponent(Entity entity) {
+        if (_archetypes)
+            return _archetypes->Has(entity, _componentManager->GetComponentType<T>());
+        return _componentManager->HasComponent<T>(entity);
+    }
+
+    // Entities owning all of Ts, iterated over the packed component arrays or archetype chunks.
+    // List read-only components as `const T` so they are not stamped as changed.
+    template <typename... Ts> ComponentView<Ts...> View() {
+        if (_archetypes)
+            return ComponentView<Ts...>(_archetypes.get(), {_componentManager->GetComponentType<std::remove_const_t<Ts>>()...});
+        return ComponentView<Ts...>(_componentManager->GetComponentArray<std::remove_const_t<Ts>>()...);
+    }
+
+    StorageBackend GetStorageBackend() const { return _archetypes ? StorageBackend::Archetype : StorageBackend::SparseSet; }
+
+    ArchetypeStorage *GetArchetypeStorage() { return _archetypes.get(); }
+
+    // Bytes currently held by component storage.
+    size_t ComponentMemoryUsage() const {
+        if (_archetypes)
+            return _archetypes->ChunkCount() * ARCHETYPE_CHUNK_SIZE;
+        return _componentManager->MemoryUsage();
+    }
 
     //---------- SYSTEM METHODS ----------
-    template <typename T> std::shared_ptr<T> RegisterSystem() { return _systemManager->RegisterSystem<T>(); }
+    // The system is owned by the scene, the pointer stays valid for the scene's lifetime.
+    template <typename T> T *RegisterSystem() { return _systemManager->RegisterSystem<T>(); }
 
     template <typename T> void SetSystemSignature(Signature signature) { _systemManager->Setsignature<T>(signature); }
 
-    void UpdateAllSystem() { _systemManager->SystemUpdateOrder(); }
+    template <typename T> void SetSystemAccess(Signature reads, Signature writes) {
+        _systemManager->SetAccess<T>(reads, writes);
+    }
+
+    // Runs the systems, then applies the structural changes they recorded.
+    void UpdateAllSystem();
+
+    //---------- DEFERRED COMMANDS ----------
+    // Command buffer of the calling thread. Threads outside the job pool share the main thread's buffer.
+    CommandBuffer &Commands() { return *_commandBuffers[Roar::JobSystem::CurrentWorker()]; }
+
+    // Sync point: plays back every thread's command buffer. Must not run while systems are updating.
+    void FlushCommands();
+
+    const std::vector<SystemTiming> &GetFrameTimeline() const { return _systemManager->GetFrameTimeline(); }
 };
+
+template <typename T> void CommandBuffer::ApplyAdd(Scene &scene, Entity entity, const std::byte *data) {
+    alignas(T) std::byte storage[sizeof(T)];
+    std::memcpy(storage, data, sizeof(T));
+    const T &component = *std::launder(reinterpret_cast<T *>(storage));
+
+    if (scene.HasComponent<T>(entity)) {
+        scene.GetComponent<T>(entity) = component;
+        scene.MarkChanged<T>(entity);
+    } else
+        scene.AddComponentDeferred<T>(entity, component);
+}
+
+template <typename T> void CommandBuffer::ApplyRemove(Scene &scene, Entity entity, const std::byte *) {
+    if (scene.HasComponent<T>(entity))
+        scene.RemoveComponentDeferred<T>(entity);
+}
@@ -0,0 +1,96 @@
+#pragma once
+#include "EntityId.h"
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Maps entity IDs to slots of a packed array without hashing.
+// The sparse side is indexed by the entity's slot index and split into
+// fixed-size pages that are only allocated the first time an entity of that
+// range gets an entry, so sparse IDs do not cost a full table. The packed side
+// lists the owning entity handles contiguously, in the same order as the
+// component data it indexes; comparing against it rejects stale handles.
+class SparseSet {
+  public:
+    static constexpr std::size_t PAGE_SIZE = 1024;
+    static constexpr std::uint32_t NONE = UINT32_MAX;
+
+  private:
+    using Page = std::array<std::uint32_t, PAGE_SIZE>;
+
+    std::vector<std::unique_ptr<Page>> _pages;
+    std::vector<std::uint32_t> _packed;
+
+    std::uint32_t &Slot(std::uint32_t entity) {
+        std::size_t page = EntityIndex(entity) / PAGE_SIZE;
+
+        if (page >= _pages.size())
+            _pages.resize(page + 1);
+        if (!_pages[page]) {
+            _pages[page] = std::make_unique<Page>();
+            _pages[page]->fill(NONE);
+        }
+        return (*_pages[page])[EntityIndex(entity) % PAGE_SIZE];
+    }
+
+  public:
+    bool Contains(std::uint32_t entity) const {
+        std::size_t page = EntityIndex(entity) / PAGE_SIZE;
+
+        if (page >= _pages.size() || !_pages[page])
+            return false;
+
+        std::uint32_t index = (*_pages[page])[EntityIndex(entity) % PAGE_SIZE];
+        return index != NONE && _packed[index] == entity;
+    }
+
+    // Packed index of the entity, which must be present.
+    std::size_t Index(std::uint32_t entity) const {
+        assert(Contains(entity) && "Entity not in sparse set.");
+
+        return (*_pages[EntityIndex(entity) / PAGE_SIZE])[EntityIndex(entity) % PAGE_SIZE];
+    }
+
+    // Appends the entity to the packed array and returns its packed index.
+    std::size_t Insert(std::uint32_t entity) {
+        assert(!Contains(entity) && "Entity inserted in sparse set more than once.");
+
+        std::size_t index = _packed.size();
+        Slot(entity) = static_cast<std::uint32_t>(index);
+        _packed.push_back(entity);
+        return index;
+    }
+
+    // Removes the entity by moving the last packed entry into its slot.
+    // Callers holding parallel data must apply the same swap beforehand.
+    void Remove(std::uint32_t entity) {
+        std::size_t index = Index(entity);
+        std::uint32_t last = _packed.back();
+
+        _packed[index] = last;
+        Slot(last) = static_cast<std::uint32_t>(index);
+        Slot(entity) = NONE;
+        _packed.pop_back();
+    }
+
+    // Keeps geometric growth when called with slowly increasing capacities.
+    void Reserve(std::size_t capacity) {
+        if (capacity > _packed.capacity())
+            _packed.reserve(std::max(capacity, _packed.capacity() * 2));
+    }
+
+    void Clear() {
+        _pages.clear();
+        _packed.clear();
+    }
+
+    std::size_t MemoryUsage() const { return _pages.size() * sizeof(Page) + _packed.capacity() * sizeof(std::uint32_t); }
+
+    std::size_t Size() const { return _packed.size(); }
+    const std::uint32_t *Data() const { return _packed.data(); }
+    std::uint32_t operator[](std::size_t index) const { return _packed[index]; }
+};
@@ -0,0 +1,143 @@
+#pragma once
+#include "Entity.h"
+#include "SparseSet.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <raylib.h>
+#include <unordered_map>
+#include <vector>
+
+// Uniform grid over entity bounds, the broadphase answering "what overlaps this rectangle".
+// Each entity is listed in every cell its bounds touch. Moving within the same cells only
+// rewrites its bounds, so a grid kept in sync every frame costs little for slow movers.
+class SpatialGrid {
+  public:
+    static constexpr float DEFAULT_CELL_SIZE = 128.0f;
+
+  private:
+    // Inclusive cell coordinates covered by some bounds
+    struct CellRange {
+        int minX;
+        int minY;
+        int maxX;
+        int maxY;
+
+        bool operator==(const CellRange &) const = default;
+    };
+
+    struct Item {
+        Rectangle bounds;
+        CellRange cells;
+    };
+
+    float _cellSize;
+    SparseSet _index;
+    std::vector<Item> _items; // parallel to the packed side of _index
+    std::unordered_map<std::uint64_t, std::vector<Entity>> _cells;
+
+    static std::uint64_t CellKey(int x, int y) {
+        return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(x)) << 32) | static_cast<std::uint32_t>(y);
+    }
+
+    CellRange Cells(Rectangle bounds) const {
+        return CellRange{static_cast<int>(std::floor(bounds.x / _cellSize)), static_cast<int>(std::floor(bounds.y / _cellSize)),
+                         static_cast<int>(std::floor((bounds.x + bounds.width) / _cellSize)),
+                         static_cast<int>(std::floor((bounds.y + bounds.height) / _cellSize))};
+    }
+
+    void Link(Entity entity, const CellRange &range) {
+        for (int y = range.minY; y <= range.maxY; y++) {
+            for (int x = range.minX; x <= range.maxX; x++)
+                _cells[CellKey(x, y)].push_back(entity);
+        }
+    }
+
+    void Unlink(Entity entity, const CellRange &range) {
+        for (int y = range.minY; y <= range.maxY; y++) {
+            for (int x = range.minX; x <= range.maxX; x++) {
+                auto cell = _cells.find(CellKey(x, y));
+                std::vector<Entity> &entities = cell->second;
+
+                *std::find(entities.begin(), entities.end(), entity) = entities.back();
+                entities.pop_back();
+                // Cells left behind by scrolling entities would otherwise pile up
+                if (entities.empty())
+                    _cells.erase(cell);
+            }
+        }
+    }
+
+    static bool Overlaps(const Rectangle &a, const Rectangle &b) {
+        return a.x <= b.x + b.width && b.x <= a.x + a.width && a.y <= b.y + b.height && b.y <= a.y + a.height;
+    }
+
+  public:
+    explicit SpatialGrid(float cellSize = DEFAULT_CELL_SIZE) : _cellSize(cellSize) {}
+
+    // Inserts the entity or moves it to `bounds`.
+    void Set(Entity entity, Rectangle bounds) {
+        CellRange range = Cells(bounds);
+
+        if (!_index.Contains(entity)) {
+            _index.Insert(entity);
+            _items.push_back(Item{bounds, range});
+            Link(entity, range);
+            return;
+        }
+
+        Item &item = _items[_index.Index(entity)];
+        if (!(item.cells == range)) {
+            Unlink(entity, item.cells);
+            Link(entity, range);
+            item.cells = range;
+        }
+        item.bounds = bounds;
+    }
+
+    // No-op for an entity not in the grid.
+    void Remove(Entity entity) {
+        if (!_index.Contains(entity))
+            return;
+
+        std::size_t index = _index.Index(entity);
+        Unlink(entity, _items[index].cells);
+        _items[index] = _items.back();
+        _items.pop_back();
+        _index.Remove(entity);
+    }
+
+    bool Contains(Entity entity) const { return _index.Contains(entity); }
+
+    // Calls func(entity, bounds) once for every entity whose bounds overlap `area`.
+    template <typename Func> void Query(Rectangle area, Func &&func) const {
+        CellRange range = Cells(area);
+
+        for (int y = range.minY; y <= range.maxY; y++) {
+            for (int x = range.minX; x <= range.maxX; x++) {
+                auto cell = _cells.find(CellKey(x, y));
+                if (cell == _cells.end())
+                    continue;
+
+                for (Entity entity : cell->second) {
+                    const Item &item = _items[_index.Index(entity)];
+
+                    // Reported from the first cell it shares with the area only
+                    if (x != std::max(item.cells.minX, range.minX) || y != std::max(item.cells.minY, range.minY))
+                        continue;
+                    if (Overlaps(item.bounds, area))
+                        func(entity, item.bounds);
+                }
+            }
+        }
+    }
+
+    std::size_t Size() const { return _items.size(); }
+
+    void Clear() {
+        _index.Clear();
+        _items.clear();
+        _cells.clear();
+    }
+};
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "AssetManager.h"
+#include "EngineApi.h"
+#include "IRenderBackend.h"
+#include "raylib.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Roar {
+
+struct SpriteBatchStats {
+    size_t sprites = 0;
+    size_t batches = 0; // runs of sprites sharing a texture, each one raylib draw call at most
+};
+
+// Flat list of the draw commands of a frame, submitted sorted by layer then texture. raylib
+// merges consecutive quads of one texture into a single draw call, so sprites packed into a few
+// atlas pages submit as a few batches whatever order they were queued in.
+class ENGINE_API SpriteBatch {
+  public:
+    // Higher layers draw on top. Within a layer and texture, sprites keep their queuing order.
+    void Draw(TextureHandle texture, uint16_t layer, Rectangle source, Rectangle dest, Color tint) {
+        _commands.push_back(DrawCommand{DrawCommand::MakeKey(texture, layer), source, dest, tint});
+    }
+
+    void Reserve(size_t count) { _commands.reserve(count); }
+    size_t Size() const { return _commands.size(); }
+
+    // Sorts the queue, hands it to `backend` one texture run at a time and clears it.
+    void Flush(IRenderBackend &backend);
+    // Through raylib. Call between BeginDrawing() and EndDrawing().
+    void Flush();
+
+    // Of the last Flush()
+    const SpriteBatchStats &GetStats() const { return _stats; }
+
+  private:
+    // Past this many layer and texture pairs, Sort() falls back to a comparison sort
+    static constexpr size_t MAX_COUNTED_KEYS = 64;
+
+    struct Run {
+        uint64_t key;
+        size_t count; // commands with this key, then where the next one goes
+    };
+
+    std::vector<DrawCommand> _commands;
+    std::vector<DrawCommand> _sorted;
+    std::vector<Run> _runs;
+    SpriteBatchStats _stats;
+
+    void Sort();
+};
+
+} // namespace Roar
@@ -4,9 +4,29 @@
 #include <set>
 
 class System {
+    private:
+        // Kept in sync by SystemManager
+        friend class SystemManager;
+        std::set<Entity> _matched;
     public:
-        std::set<Entity> _entities;
+        // Read-only names used by systems written against the old APIs
+        const std::set<Entity> &_entities = _matched;
+        const std::set<Entity> &mEntities = _matched;
         int order = 0;
+        // Must run on the main thread (input, window or draw calls)
+        bool mainThread = false;
+        // Creates or destroys entities, or adds or removes components: never runs alongside another system
+        bool structural = false;
     public:
-        virtual void Update() = 0;
+        System() = default;
+        // Owned by SystemManager, the aliases above would stay bound to the source of a copy
+        System(const System &) = delete;
+        System &operator=(const System &) = delete;
+        virtual ~System() = default;
+        virtual void Update() {}
+        // Called by Scene::Clear(), once every entity is gone. Systems caching per-entity state drop it here.
+        virtual void OnClear() {}
+
+        // Entities whose signature matches the system's
+        const std::set<Entity> &Entities() const { return _matched; }
 };
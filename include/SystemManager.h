@@ -1,67 +1,172 @@
 #pragma once
     #include "System.h"
     #include "Signature.h"
+    #include "TypeId.h"
+    #include "ChangeTick.h"
+    #include <array>
+    #include <atomic>
+    #include <cassert>
+    #include <chrono>
+    #include <condition_variable>
+    #include <deque>
     #include <memory>
+    #include <mutex>
+    #include <span>
+    #include <typeinfo>
     #include <unordered_map>
+    #include <vector>
     #include <algorithm>
 
-class SystemManager {
+// Where and when a system ran during the last UpdateAllSystem(), relative to its start.
+struct SystemTiming {
+    const char *name;
+    uint32_t worker; // 0 is the main thread
+    double startMs;
+    double endMs;
+};
+
+class ECS_API SystemManager {
     private:
-        std::unordered_map<const char *, Signature> _signatures{};
-        std::unordered_map<const char *, std::shared_ptr<System>> _systems{};
+        struct SystemEntry {
+            std::unique_ptr<System> system;
+            Signature signature;
+            Signature reads;
+            Signature writes;
+            const char *name;
+            uint32_t visited = 0;
+            Tick lastRun = 0; // change tick of the system's previous run
+        };
+
+        // One node per system, in `order`. Each node waits for the earlier nodes it conflicts with.
+        struct ScheduleNode {
+            size_t system;
+            int order; // order the schedule was built with
+            uint32_t dependencies = 0;
+            std::vector<size_t> dependents{};
+        };
+
+        std::vector<SystemEntry> _systems{};
+        std::unordered_map<TypeId, size_t> _systemIndex{};
+        // Component bit -> systems whose signature contains it
+        std::array<std::vector<size_t>, MAX_COMPONENTS> _systemsByComponent{};
+        // Systems with an empty signature match every entity that has a component
+        std::vector<size_t> _unfilteredSystems{};
+        uint32_t _visitStamp = 0;
+
+        std::vector<ScheduleNode> _schedule{};
+        bool _scheduleDirty = true;
+        std::unique_ptr<std::atomic<uint32_t>[]> _remaining{};
+        std::deque<size_t> _mainQueue{};
+        size_t _completed = 0;
+        std::mutex _runMutex;
+        std::condition_variable _runCondition;
+        std::chrono::steady_clock::time_point _frameStart{};
+        std::vector<SystemTiming> _timeline{};
+
+        static bool Matches(Signature entitySignature, Signature systemSignature) {
+            return (entitySignature & systemSignature) == systemSignature;
+        }
+
+        void UpdateMembership(size_t index, std::span<const Entity> entities, Signature oldSignature, Signature newSignature) {
+            SystemEntry &entry = _systems[index];
+
+            if (entry.visited == _visitStamp)
+                return;
+            entry.visited = _visitStamp;
+
+            bool wasMember = !oldSignature.none() && Matches(oldSignature, entry.signature);
+            bool isMember = !newSignature.none() && Matches(newSignature, entry.signature);
+
+            if (isMember && !wasMember)
+                entry.system->_matched.insert(entities.begin(), entities.end());
+            else if (wasMember && !isMember) {
+                for (Entity entity : entities)
+                    entry.system->_matched.erase(entity);
+            }
+        }
+
+        // Structural systems and systems that never declared their access get the frame to themselves.
+        static bool Exclusive(const SystemEntry &entry);
+        static bool Conflicts(const SystemEntry &a, const SystemEntry &b);
+        bool ScheduleOutdated() const;
+        void BuildSchedule();
+        void Dispatch(size_t node);
+        void Execute(size_t node);
+
     public:
         template<typename T>
-        std::shared_ptr<T> RegisterSystem() {
-            const char *typeName = typeid(T).name();
+        T *RegisterSystem() {
+            TypeId typeId = GetTypeId<T>();
 
-            assert(_systems.find(typeName) == _systems.end() && "Register system more than once.");
+            assert(_systemIndex.find(typeId) == _systemIndex.end() && "Register system more than once.");
 
-            auto system = std::make_shared<T>();
-            _systems.insert({typeName, system});
-            return system;
+            auto system = std::make_unique<T>();
+            T *raw = system.get();
+            _systemIndex.insert({typeId, _systems.size()});
+            _unfilteredSystems.push_back(_systems.size());
+            _systems.push_back(SystemEntry{std::move(system), Signature{}, Signature{}, Signature{}, typeid(T).name()});
+            _scheduleDirty = true;
+            return raw;
         }
 
         template<typename T>
         void Setsignature(Signature signature) {
-            const char *typeName = typeid(T).name();
+            TypeId typeId = GetTypeId<T>();
 
-            assert(_systems.find(typeName) != _systems.end() && "System used before registered.");
+            assert(_systemIndex.find(typeId) != _systemIndex.end() && "System used before registered.");
 
-            _signatures.insert({typeName, signature});
-        }
+            size_t index = _systemIndex[typeId];
+            _systems[index].signature = signature;
 
-        void EntityDestroyed(Entity entity) {
-            for (auto const& pair : _systems) {
-                auto const& system = pair.second;
-                system->_entities.erase(entity);
+            // Rebuild this system's entries in the component index
+            for (auto &systems : _systemsByComponent)
+                systems.erase(std::remove(systems.begin(), systems.end(), index), systems.end());
+            _unfilteredSystems.erase(std::remove(_unfilteredSystems.begin(), _unfilteredSystems.end(), index),
+                                     _unfilteredSystems.end());
+
+            if (signature.none())
+                _unfilteredSystems.push_back(index);
+            for (ComponentType type = 0; type < MAX_COMPONENTS; type++) {
+                if (signature.test(type))
+                    _systemsByComponent[type].push_back(index);
             }
         }
 
-        void EntitySignatureChanged(Entity entity, Signature signature) {
-            for (auto const& pair: _systems) {
-                auto const& type = pair.first;
-                auto const& system = pair.second;
-                auto const& systemSignature = _signatures[type];
+        // Components the system reads and writes; systems with disjoint writes may run concurrently.
+        template<typename T>
+        void SetAccess(Signature reads, Signature writes) {
+            TypeId typeId = GetTypeId<T>();
 
-                if ((signature & systemSignature) == systemSignature)
-                    system->_entities.insert(entity);
-                else
-                    system->_entities.erase(entity);
-            }
+            assert(_systemIndex.find(typeId) != _systemIndex.end() && "System used before registered.");
+
+            SystemEntry &entry = _systems[_systemIndex[typeId]];
+            entry.reads = reads;
+            entry.writes = writes;
+            _scheduleDirty = true;
         }
-    
-        void SystemUpdateOrder() {
-            std::vector<std::shared_ptr<System>> tmp{};
 
-            for (auto i = _systems.begin(); i != _systems.end(); i++) {
-                tmp.push_back(i->second);
-            }
-            std::sort(tmp.begin(), tmp.end(),
-                [](auto& a, auto& b) {
-                    return a->order < b->order;
-                }
-            );
-            for (auto i = 0; i < tmp.size(); i++)
-                tmp[i]->Update();
+        void EntityDestroyed(Entity entity, Signature signature) {
+            EntitySignatureChanged(entity, signature, Signature{});
         }
+
+        // Only the systems that care about a component whose bit flipped are visited,
+        // and each of them sees at most one insert or erase.
+        void EntitySignatureChanged(Entity entity, Signature oldSignature, Signature newSignature) {
+            EntitiesSignatureChanged(std::span<const Entity>(&entity, 1), oldSignature, newSignature);
+        }
+
+        // Same for a batch of entities sharing both signatures: the systems to update are looked up once.
+        void EntitiesSignatureChanged(std::span<const Entity> entities, Signature oldSignature, Signature newSignature);
+
+        // Runs every system once. Each system starts as soon as the earlier systems it conflicts with
+        // are done: worker systems go to the job pool, main-thread ones run here.
+        void SystemUpdateOrder();
+
+        // Change tick of the system that ran the longest ago, the current tick if there are no systems.
+        Tick OldestRun() const;
+
+        // Empties every system's entity set and tells the system through OnClear().
+        void Clear();
+
+        const std::vector<SystemTiming> &GetFrameTimeline() const { return _timeline; }
 };
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "AssetManager.h"
+#include "EngineApi.h"
+#include "raylib.h"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Roar {
+
+// Where a packed file landed: its page and its rectangle in that page, in pixels.
+struct AtlasRegion {
+    TextureHandle page;
+    Rectangle rect;
+};
+
+// Packs several image files into a few large pages at load time, so sprites cut from different
+// files share a texture and draw in one batch. Source rects written against an original file are
+// moved into its page with Remap(). Holds a reference on each page until destroyed.
+class ENGINE_API TextureAtlas {
+  public:
+    static constexpr int DEFAULT_PAGE_SIZE = 2048;
+
+    // Position of one image after packing. Page -1 if it is larger than a page.
+    struct Placement {
+        int page;
+        int x;
+        int y;
+    };
+
+    TextureAtlas() = default;
+    explicit TextureAtlas(const std::vector<std::string> &paths, int pageSize = DEFAULT_PAGE_SIZE, int padding = 1) {
+        Build(paths, pageSize, padding);
+    }
+    ~TextureAtlas();
+
+    TextureAtlas(const TextureAtlas &) = delete;
+    TextureAtlas &operator=(const TextureAtlas &) = delete;
+
+    // Loads `paths` and packs them into pages of at most `pageSize` pixels square, `padding`
+    // transparent pixels apart. Files that fail to load or do not fit a page are skipped with a
+    // warning. Main thread only, the pages are uploaded through Assets().
+    void Build(const std::vector<std::string> &paths, int pageSize = DEFAULT_PAGE_SIZE, int padding = 1);
+
+    // Null if `path` was not packed.
+    const AtlasRegion *Find(const std::string &path) const;
+
+    const std::vector<TextureHandle> &Pages() const { return _pages; }
+
+    // `source`, a rect in the original file of `region`, moved into its page.
+    static Rectangle Remap(const AtlasRegion &region, Rectangle source) {
+        return Rectangle{region.rect.x + source.x, region.rect.y + source.y, source.width, source.height};
+    }
+
+    // Shelf packing: tallest images first, placed left to right along shelves as tall as their first
+    // image, a new page starting when a shelf no longer fits. Works on sizes only, without a GPU.
+    static std::vector<Placement> Pack(const std::vector<Vector2> &sizes, int pageSize, int padding);
+
+  private:
+    std::vector<TextureHandle> _pages;
+    std::unordered_map<std::string, AtlasRegion> _regions;
+};
+
+} // namespace Roar
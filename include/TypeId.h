@@ -0,0 +1,44 @@
+#pragma once
+#include "EcsApi.h"
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+
+using TypeId = std::uint32_t;
+
+namespace TypeInfo {
+
+// Compiler-generated signature of this function, which spells out T.
+template <typename T> constexpr std::string_view Name() {
+#if defined(_MSC_VER)
+    return __FUNCSIG__;
+#else
+    return __PRETTY_FUNCTION__;
+#endif
+}
+
+// 64-bit FNV-1a, evaluated at compile time on the name above.
+constexpr std::uint64_t Hash(std::string_view name) {
+    std::uint64_t hash = 14695981039346656037ull;
+
+    for (char c : name) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// Hands out dense IDs in first-seen order. The table lives in ECSPlugin, so the
+// game and every plugin agree on the ID of a type whichever library asks first.
+ECS_API TypeId Register(std::uint64_t hash);
+ECS_API TypeId Count();
+
+} // namespace TypeInfo
+
+template <typename T> constexpr std::uint64_t TYPE_HASH = TypeInfo::Hash(TypeInfo::Name<std::remove_cv_t<T>>());
+
+// Dense, process-wide ID of T. Only the first call per library reaches the registry.
+template <typename T> TypeId GetTypeId() {
+    static const TypeId id = TypeInfo::Register(TYPE_HASH<T>);
+    return id;
+}
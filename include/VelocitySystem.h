@@ -8,12 +8,9 @@ extern Scene _core;
 class VelocitySystem : public System {
   public:
     void Update() override {
-
-        for (auto const &entity : _entities) {
-            auto &pos = _core.GetComponent<Position>(entity);
-            auto &velocity = _core.GetComponent<Velocity>(entity);
+        _core.View<Position, const Velocity>().ParallelEach([](Position &pos, const Velocity &velocity) {
             pos.position.x += velocity.speedX;
             pos.position.y += velocity.speedY;
-        }
+        });
     }
 };
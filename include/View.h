@@ -0,0 +1,219 @@
+#pragma once
+#include "Archetype.h"
+#include "ComponentArray.h"
+#include "JobSystem.h"
+#include <algorithm>
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Iterates the entities owning every component in Ts.
+// On the sparse-set backend the walk is driven by the packed entity list of the
+// smallest array, so it is a linear scan whose length is bounded by the rarest
+// component; the other arrays are probed through their sparse index.
+// On the archetype backend it walks the columns of every matching chunk.
+// Entities must not be created or destroyed, nor components added or removed,
+// from inside Each() or ParallelEach().
+// Components listed as `const T` are read-only; every other component visited
+// is stamped as changed, whether func writes to it or not.
+template <typename... Ts> class ComponentView {
+  private:
+    static constexpr size_t N = sizeof...(Ts);
+    static constexpr bool MUTABLE = (!std::is_const_v<Ts> || ...);
+
+    std::tuple<ComponentArray<std::remove_const_t<Ts>> *...> _arrays{};
+    ArchetypeStorage *_archetypes = nullptr;
+    std::array<ComponentType, N> _types{};
+    // Per component, only entities stamped after these ticks pass. Ticks start at 1, so 0 lets everything through.
+    std::array<Tick, N> _changedSince{};
+    std::array<Tick, N> _addedSince{};
+    bool _filtered = false;
+    Tick _now = 0;
+
+    template <typename T> static constexpr size_t IndexOf() {
+        constexpr bool matches[] = {std::is_same_v<std::remove_const_t<Ts>, T>...};
+
+        for (size_t i = 0; i < N; i++) {
+            if (matches[i])
+                return i;
+        }
+        return N;
+    }
+
+    bool Passes(const ComponentTicks &ticks, size_t index) const {
+        return ticks.changed > _changedSince[index] && ticks.added > _addedSince[index];
+    }
+
+    template <size_t I> void Stamp(ComponentTicks &ticks) const {
+        if constexpr (!std::is_const_v<std::tuple_element_t<I, std::tuple<Ts...>>>)
+            ticks.changed = _now;
+    }
+
+    const IComponentArray *SmallestArray() const {
+        const IComponentArray *smallest = nullptr;
+        size_t smallestSize = SIZE_MAX;
+
+        std::apply(
+            [&](auto *...array) {
+                ((array->Size() < smallestSize ? (smallest = array, smallestSize = array->Size()) : 0), ...);
+            },
+            _arrays);
+        return smallest;
+    }
+
+    // The driving array is indexed directly, the others go through their sparse index.
+    template <typename T> static T &Fetch(ComponentArray<T> *array, const IComponentArray *driver, Entity entity, size_t index) {
+        if (array == driver)
+            return array->At(index);
+        return array->GetData(entity);
+    }
+
+    template <typename T>
+    static ComponentTicks &FetchTicks(ComponentArray<T> *array, const IComponentArray *driver, Entity entity, size_t index) {
+        if (array == driver)
+            return array->TicksAt(index);
+        return array->GetTicks(entity);
+    }
+
+    // Visits the matches driven by packed indices [begin, end) of the driving array.
+    template <typename Func, size_t... I>
+    void EachSparse(Func &func, const IComponentArray *driver, size_t begin, size_t end, std::index_sequence<I...>) {
+        const Entity *entities = nullptr;
+        ((std::get<I>(_arrays) == driver ? (entities = std::get<I>(_arrays)->Entities(), 0) : 0), ...);
+
+        for (size_t i = begin; i < end; i++) {
+            Entity entity = entities[i];
+
+            if (!(std::get<I>(_arrays)->HasData(entity) && ...))
+                continue;
+            if (_filtered && !(Passes(FetchTicks(std::get<I>(_arrays), driver, entity, i), I) && ...))
+                continue;
+            if constexpr (MUTABLE)
+                (Stamp<I>(FetchTicks(std::get<I>(_arrays), driver, entity, i)), ...);
+            if constexpr (std::is_invocable_v<Func, Entity, Ts &...>)
+                func(entity, Fetch(std::get<I>(_arrays), driver, entity, i)...);
+            else
+                func(Fetch(std::get<I>(_arrays), driver, entity, i)...);
+        }
+    }
+
+    template <typename Func> void EachSparse(Func &func, const IComponentArray *driver, size_t begin, size_t end) {
+        EachSparse(func, driver, begin, end, std::index_sequence_for<Ts...>{});
+    }
+
+    template <typename Func> void EachSparse(Func &func) {
+        const IComponentArray *driver = SmallestArray();
+
+        EachSparse(func, driver, 0, DriverSize(driver));
+    }
+
+    size_t DriverSize(const IComponentArray *driver) const {
+        size_t size = 0;
+
+        std::apply([&](auto *...array) { ((array == driver ? (size = array->Size(), 0) : 0), ...); }, _arrays);
+        return size;
+    }
+
+    template <typename Func, size_t... I>
+    void EachRows(Func &func, Archetype &archetype, ArchetypeChunk &chunk, std::index_sequence<I...>) {
+        Entity *entities = archetype.Entities(chunk);
+        std::tuple<Ts *...> columns{static_cast<Ts *>(archetype.Column(chunk, _types[I]))...};
+        std::array<ComponentTicks *, N> ticks{};
+
+        if (_filtered || MUTABLE)
+            ticks = {archetype.Ticks(chunk, _types[I])...};
+        for (size_t row = 0; row < chunk.count; row++) {
+            if (_filtered && !(Passes(ticks[I][row], I) && ...))
+                continue;
+            if constexpr (MUTABLE)
+                (Stamp<I>(ticks[I][row]), ...);
+            if constexpr (std::is_invocable_v<Func, Entity, Ts &...>)
+                func(entities[row], std::get<I>(columns)[row]...);
+            else
+                func(std::get<I>(columns)[row]...);
+        }
+    }
+
+    Signature Required() const {
+        Signature required;
+
+        for (ComponentType type : _types)
+            required.set(type, true);
+        return required;
+    }
+
+    template <typename Func> void EachChunk(Func &func) {
+        _archetypes->EachArchetype(Required(), [&](Archetype &archetype) {
+            for (auto &chunk : archetype.Chunks())
+                EachRows(func, archetype, chunk, std::index_sequence_for<Ts...>{});
+        });
+    }
+
+  public:
+    explicit ComponentView(ComponentArray<std::remove_const_t<Ts>> *...arrays) : _arrays(arrays...) {}
+
+    ComponentView(ArchetypeStorage *archetypes, std::array<ComponentType, sizeof...(Ts)> types)
+        : _archetypes(archetypes), _types(types) {}
+
+    // Only visits entities whose T was added or written after `since`, by default
+    // since the previous run of the calling system (everything outside of a system).
+    template <typename T> ComponentView &Changed(Tick since = ChangeTicks::LastRun()) {
+        static_assert(IndexOf<T>() < N, "Filtered component must be part of the view.");
+
+        _changedSince[IndexOf<T>()] = since;
+        _filtered = true;
+        return *this;
+    }
+
+    // Only visits entities that got T after `since`, with the same default as Changed().
+    template <typename T> ComponentView &Added(Tick since = ChangeTicks::LastRun()) {
+        static_assert(IndexOf<T>() < N, "Filtered component must be part of the view.");
+
+        _addedSince[IndexOf<T>()] = since;
+        _filtered = true;
+        return *this;
+    }
+
+    // Calls func(entity, components...) or func(components...) for each match.
+    template <typename Func> void Each(Func &&func) {
+        _now = ChangeTicks::Now();
+        if (_archetypes)
+            EachChunk(func);
+        else
+            EachSparse(func);
+    }
+
+    // Same as Each() with the matches split across the job pool: `grain` entities
+    // (sparse set) or chunks (archetype) per job, 0 letting the pool choose.
+    // func runs concurrently and must only write to the components it is handed.
+    template <typename Func> void ParallelEach(Func &&func, size_t grain = 0) {
+        Roar::JobSystem &jobs = Roar::Jobs();
+
+        // Stamped with the caller's tick, the pool threads run outside of any system
+        _now = ChangeTicks::Now();
+        if (jobs.WorkerCount() == 0) {
+            Each(func);
+            return;
+        }
+        if (_archetypes) {
+            std::vector<std::pair<Archetype *, ArchetypeChunk *>> chunks;
+
+            _archetypes->EachArchetype(Required(), [&](Archetype &archetype) {
+                for (auto &chunk : archetype.Chunks())
+                    chunks.emplace_back(&archetype, &chunk);
+            });
+            if (grain == 0)
+                grain = std::max<size_t>(1, chunks.size() / ((jobs.WorkerCount() + 1) * 4));
+            jobs.ParallelFor(chunks.size(), grain, [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; i++)
+                    EachRows(func, *chunks[i].first, *chunks[i].second, std::index_sequence_for<Ts...>{});
+            });
+            return;
+        }
+
+        const IComponentArray *driver = SmallestArray();
+        jobs.ParallelFor(DriverSize(driver), grain, [&](size_t begin, size_t end) { EachSparse(func, driver, begin, end); });
+    }
+};
@@ -15,6 +15,7 @@
 
 #define MIN_FLOAT_VAL -1000 // Minimum value of networked client float value
 #define MAX_FLOAT_VAL 1000  // Maximum value of networked client float value
+#define POSITION_BITS 14    // Networked float positions, steps of 1/8 pixel between the two
 
 // Maximum number of connected clients at a time
 #define MAX_CLIENTS 4
@@ -28,6 +29,9 @@
 // Max number of missiles that can be sent to the server
 #define MAX_MISSILES_CLIENT 100
 
+// Missile animation frames in the player sprite sheet
+#define MISSILE_FRAME_COUNT 5
+
 // Max number of mobs in the game
 #define MAX_MOBS 20
 
@@ -47,6 +51,12 @@
 // Client timeout in ticks (if no message received for this many ticks, client is considered disconnected)
 #define CLIENT_TIMEOUT_TICKS 180
 
+// Game states kept by both ends to encode and decode snapshot deltas against, one per tick
+#define SNAPSHOT_HISTORY 32
+
+// Snapshot tick of no snapshot at all, acknowledged before the first one arrives
+#define NO_SNAPSHOT UINT32_MAX
+
 // Message types
 enum MessageType : uint8_t {
     MSG_CONNECT_REQUEST = 1,
@@ -58,6 +68,7 @@ enum MessageType : uint8_t {
     MSG_HEARTBEAT
 };
 
+// Only pos and currentFrame go over the network, rect follows from the frame and the rest animates locally
 typedef struct {
     Vector2 pos;
     Rectangle rect;
@@ -79,6 +90,7 @@ typedef struct {
 typedef struct {
     int x;
     int y;
+    uint32_t ack_tick; // Latest game state snapshot received, the server encodes the next ones against it
     unsigned int missile_count;
     Missile missiles[MAX_MISSILES_CLIENT];
 } UpdateStateMessage;
@@ -103,6 +115,12 @@ typedef struct {
     bool wave_active;          // Si une vague est en cours
 } GameStateMessage;
 
+// Last SNAPSHOT_HISTORY game states by tick. The server records what it sent, the client what it decoded.
+typedef struct {
+    uint32_t ticks[SNAPSHOT_HISTORY];
+    GameStateMessage states[SNAPSHOT_HISTORY];
+} SnapshotHistory;
+
 // Connection accept data sent to client
 typedef struct {
     uint32_t client_id;
@@ -110,7 +128,9 @@ typedef struct {
     int spawn_y;
 } ConnectAcceptData;
 
-// Serialization functions using NetBuffer
+extern const Rectangle MISSILE_FRAMES[MISSILE_FRAME_COUNT];
+
+// Serialization functions, bit packed into a NetBuffer
 void SerializeMissile(Roar::INetBuffer &buffer, const Missile &missile);
 Missile DeserializeMissile(Roar::INetBuffer &buffer);
 
@@ -126,5 +146,19 @@ MobState DeserializeMobState(Roar::INetBuffer &buffer);
 void SerializeGameStateMessage(Roar::INetBuffer &buffer, const GameStateMessage &msg);
 GameStateMessage DeserializeGameStateMessage(Roar::INetBuffer &buffer);
 
+// Snapshots
+void ClearSnapshots(SnapshotHistory &history);
+void StoreSnapshot(SnapshotHistory &history, uint32_t tick, const GameStateMessage &state);
+// Null once the snapshot of `tick` was overwritten or never stored
+const GameStateMessage *FindSnapshot(const SnapshotHistory &history, uint32_t tick);
+
+// MSG_GAME_STATE payload: the snapshot of `tick` as the fields that changed since `base`, the snapshot of
+// `base_tick` the client acknowledged. Without a base (NO_SNAPSHOT), every field is sent.
+void SerializeGameStateDelta(Roar::INetBuffer &buffer, uint32_t tick, const GameStateMessage &state, uint32_t base_tick,
+                             const GameStateMessage *base);
+void DeserializeSnapshotHeader(Roar::INetBuffer &buffer, uint32_t &tick, uint32_t &base_tick);
+// Reads what follows the header, `base` being the snapshot of its base tick or null for NO_SNAPSHOT
+GameStateMessage DeserializeGameStateDelta(Roar::INetBuffer &buffer, const GameStateMessage *base);
+
 void SerializeConnectAcceptData(Roar::INetBuffer &buffer, const ConnectAcceptData &data);
 ConnectAcceptData DeserializeConnectAcceptData(Roar::INetBuffer &buffer);
@@ -0,0 +1,314 @@
+#include "AssetManager.h"
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <spdlog/spdlog.h>
+#include <thread>
+
+namespace Roar {
+
+namespace {
+const Texture2D emptyTexture{};
+
+double MsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+size_t TextureBytes(const Texture2D &texture) {
+    size_t bytes = 0;
+
+    for (int level = 0; level < std::max(texture.mipmaps, 1); level++)
+        bytes += GetPixelDataSize(std::max(texture.width >> level, 1), std::max(texture.height >> level, 1), texture.format);
+    return bytes;
+}
+} // namespace
+
+AssetManager::~AssetManager() {
+    while (_decoding.load(std::memory_order_acquire) > 0) {
+        if (!Jobs().RunPending())
+            std::this_thread::yield();
+    }
+    for (DecodedImage &decoded : _decoded)
+        UnloadImage(decoded.image);
+    for (TextureSlot &slot : _textures) {
+        if (slot.state == AssetState::Decoded)
+            UnloadImage(slot.image);
+    }
+}
+
+TextureHandle AssetManager::AcquireTexture(const std::string &path) {
+    auto cached = _byPath.find(path);
+    if (cached != _byPath.end()) {
+        TextureHandle handle = cached->second;
+
+        _stats.cacheHits++;
+        Acquire(handle);
+        WaitDecoded(handle);
+        if (TextureSlot *slot = Resolve(handle); slot->state == AssetState::Decoded)
+            Upload(*slot);
+        return handle;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    Texture2D texture = ::LoadTexture(path.c_str());
+    _stats.loadMs += MsSince(start);
+    _stats.loads++;
+    if (texture.id == 0) {
+        spdlog::warn("Failed to load texture {}", path);
+        return TextureHandle{};
+    }
+
+    return AddTexture(path, texture);
+}
+
+TextureHandle AssetManager::AcquireTexture(const std::string &name, const Image &image) {
+    auto cached = _byPath.find(name);
+    if (cached != _byPath.end()) {
+        _stats.cacheHits++;
+        Acquire(cached->second);
+        return cached->second;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    Texture2D texture = LoadTextureFromImage(image);
+    _stats.loadMs += MsSince(start);
+    _stats.loads++;
+    if (texture.id == 0) {
+        spdlog::warn("Failed to upload texture {}", name);
+        return TextureHandle{};
+    }
+
+    return AddTexture(name, texture);
+}
+
+TextureHandle AssetManager::AcquireTextureAsync(const std::string &path) {
+    auto cached = _byPath.find(path);
+    if (cached != _byPath.end()) {
+        _stats.cacheHits++;
+        Acquire(cached->second);
+        return cached->second;
+    }
+
+    TextureHandle handle = AllocateSlot(path);
+    Resolve(handle)->state = AssetState::Decoding;
+    _stats.loads++;
+    _stats.pending++;
+
+    // The job only touches the mutex guarded list, the slot may be evicted or reused before it finishes
+    _decoding.fetch_add(1, std::memory_order_relaxed);
+    Jobs().Submit([this, handle, path] {
+        auto start = std::chrono::steady_clock::now();
+        Image image = LoadImage(path.c_str());
+        double decodeMs = MsSince(start);
+
+        {
+            std::lock_guard<std::mutex> lock(_decodedMutex);
+            _decoded.push_back(DecodedImage{handle, image, decodeMs});
+        }
+        _decoding.fetch_sub(1, std::memory_order_release);
+    });
+    return handle;
+}
+
+void AssetManager::Update(double budgetMs) {
+    Collect();
+    if (_stats.pending == 0)
+        return;
+
+    auto start = std::chrono::steady_clock::now();
+    for (TextureSlot &slot : _textures) {
+        if (slot.state != AssetState::Decoded)
+            continue;
+        Upload(slot);
+        if (MsSince(start) >= budgetMs)
+            break;
+    }
+}
+
+void AssetManager::Collect() {
+    std::vector<DecodedImage> decoded;
+
+    {
+        std::lock_guard<std::mutex> lock(_decodedMutex);
+        if (_decoded.empty())
+            return;
+        decoded.swap(_decoded);
+    }
+    for (DecodedImage &result : decoded) {
+        TextureSlot *slot = Resolve(result.handle);
+
+        _stats.decodeMs += result.decodeMs;
+        if (!slot) {
+            // Released while decoding
+            UnloadImage(result.image);
+        } else if (result.image.data == nullptr) {
+            spdlog::warn("Failed to load texture {}", slot->path);
+            slot->state = AssetState::Failed;
+            _stats.pending--;
+        } else {
+            slot->image = result.image;
+            slot->state = AssetState::Decoded;
+        }
+    }
+}
+
+void AssetManager::WaitDecoded(TextureHandle handle) {
+    Collect();
+    while (GetState(handle) == AssetState::Decoding) {
+        if (!Jobs().RunPending())
+            std::this_thread::yield();
+        Collect();
+    }
+}
+
+AssetState AssetManager::GetState(TextureHandle handle) const {
+    const TextureSlot *slot = Resolve(handle);
+
+    return slot ? slot->state : AssetState::Invalid;
+}
+
+const Image *AssetManager::GetImage(TextureHandle handle) const {
+    const TextureSlot *slot = Resolve(handle);
+
+    return slot && slot->state == AssetState::Decoded ? &slot->image : nullptr;
+}
+
+void AssetManager::Acquire(TextureHandle handle) {
+    TextureSlot *slot = Resolve(handle);
+
+    assert(slot && "Acquire on a stale texture handle.");
+    if (slot)
+        slot->refCount++;
+}
+
+void AssetManager::Release(TextureHandle handle) {
+    TextureSlot *slot = Resolve(handle);
+
+    if (!slot)
+        return;
+    if (--slot->refCount == 0)
+        Evict((handle.id & INDEX_MASK) - 1);
+}
+
+bool AssetManager::IsValid(TextureHandle handle) const { return Resolve(handle) != nullptr; }
+
+const Texture2D &AssetManager::GetTexture(TextureHandle handle) const {
+    const TextureSlot *slot = Resolve(handle);
+
+    return slot ? slot->texture : emptyTexture;
+}
+
+void AssetManager::Clear() {
+    for (uint32_t index = 0; index < _textures.size(); index++) {
+        if (_textures[index].refCount > 0)
+            Evict(index);
+    }
+}
+
+AssetManager::TextureSlot *AssetManager::Resolve(TextureHandle handle) {
+    return const_cast<TextureSlot *>(static_cast<const AssetManager *>(this)->Resolve(handle));
+}
+
+const AssetManager::TextureSlot *AssetManager::Resolve(TextureHandle handle) const {
+    uint32_t index = (handle.id & INDEX_MASK) - 1;
+
+    if (!handle || index >= _textures.size())
+        return nullptr;
+
+    const TextureSlot &slot = _textures[index];
+    if (slot.refCount == 0 || slot.generation != handle.id >> 16)
+        return nullptr;
+    return &slot;
+}
+
+TextureHandle AssetManager::AllocateSlot(const std::string &path) {
+    uint32_t index;
+
+    if (!_freeSlots.empty()) {
+        index = _freeSlots.back();
+        _freeSlots.pop_back();
+    } else {
+        assert(_textures.size() < INDEX_MASK && "Too many textures loaded.");
+        index = static_cast<uint32_t>(_textures.size());
+        _textures.emplace_back();
+    }
+
+    TextureSlot &slot = _textures[index];
+    slot.path = path;
+    slot.refCount = 1;
+
+    TextureHandle handle{(static_cast<uint32_t>(slot.generation) << 16) | (index + 1)};
+    _byPath.emplace(path, handle);
+    return handle;
+}
+
+TextureHandle AssetManager::AddTexture(const std::string &path, Texture2D texture) {
+    TextureHandle handle = AllocateSlot(path);
+    TextureSlot &slot = *Resolve(handle);
+
+    slot.texture = texture;
+    slot.state = AssetState::Ready;
+    slot.bytes = TextureBytes(texture);
+    _stats.textureCount++;
+    _stats.textureBytes += slot.bytes;
+    return handle;
+}
+
+void AssetManager::Upload(TextureSlot &slot) {
+    auto start = std::chrono::steady_clock::now();
+    slot.texture = LoadTextureFromImage(slot.image);
+    UnloadImage(slot.image);
+    slot.image = Image{};
+    _stats.uploadMs += MsSince(start);
+    _stats.pending--;
+
+    if (slot.texture.id == 0) {
+        spdlog::warn("Failed to upload texture {}", slot.path);
+        slot.state = AssetState::Failed;
+        return;
+    }
+    slot.state = AssetState::Ready;
+    slot.bytes = TextureBytes(slot.texture);
+    _stats.textureCount++;
+    _stats.textureBytes += slot.bytes;
+}
+
+void AssetManager::Evict(uint32_t index) {
+    TextureSlot &slot = _textures[index];
+
+    switch (slot.state) {
+    case AssetState::Ready:
+        UnloadTexture(slot.texture);
+        _stats.textureCount--;
+        _stats.textureBytes -= slot.bytes;
+        break;
+    case AssetState::Decoded:
+        UnloadImage(slot.image);
+        _stats.pending--;
+        break;
+    case AssetState::Decoding:
+        // Collect() drops the image once it arrives, the generation no longer matching
+        _stats.pending--;
+        break;
+    default:
+        break;
+    }
+    _byPath.erase(slot.path);
+    _stats.evictions++;
+
+    uint16_t generation = slot.generation + 1;
+    slot = TextureSlot{};
+    slot.generation = generation;
+    _freeSlots.push_back(index);
+}
+
+AssetManager &Assets() {
+    // Started first so the pool outlives the cache, whose destructor waits for pending decodes
+    Jobs();
+    static AssetManager assets;
+    return assets;
+}
+
+} // namespace Roar
@@ -43,11 +43,13 @@ void Box2DPhysics::InitDemo(uint32_t width, uint32_t height) {
     demoData.worldDef.gravity.y = 9.8f * lengthUnitsPerMeter;
     demoData.worldId = b2CreateWorld(&demoData.worldDef);
 
-    demoData.groundTexture = LoadTexture("resources/sprites/ground.png");
-    demoData.boxTexture = LoadTexture("resources/sprites/box.png");
+    demoData.groundTexture = Assets().AcquireTexture("resources/sprites/ground.png");
+    demoData.boxTexture = Assets().AcquireTexture("resources/sprites/box.png");
 
-    demoData.groundExtent = {0.5f * demoData.groundTexture.width, 0.5f * demoData.groundTexture.height};
-    demoData.boxExtent = {0.5f * demoData.boxTexture.width, 0.5f * demoData.boxTexture.height};
+    const Texture2D &groundTexture = Assets().GetTexture(demoData.groundTexture);
+    const Texture2D &boxTexture = Assets().GetTexture(demoData.boxTexture);
+    demoData.groundExtent = {0.5f * groundTexture.width, 0.5f * groundTexture.height};
+    demoData.boxExtent = {0.5f * boxTexture.width, 0.5f * boxTexture.height};
 
     // These polygons are centered on the origin and when they are added to a body they
     // will be centered on the body position.
@@ -64,7 +66,7 @@ void Box2DPhysics::InitDemo(uint32_t width, uint32_t height) {
 
         entity->bodyId = b2CreateBody(demoData.worldId, &bodyDef);
         entity->extent = demoData.groundExtent;
-        entity->texture = demoData.groundTexture;
+        entity->texture = groundTexture;
         b2ShapeDef shapeDef = b2DefaultShapeDef();
         b2CreatePolygonShape(entity->bodyId, &shapeDef, &demoData.groundPolygon);
     }
@@ -82,7 +84,7 @@ void Box2DPhysics::InitDemo(uint32_t width, uint32_t height) {
             bodyDef.type = b2_dynamicBody;
             bodyDef.position = b2Vec2{x, y};
             entity->bodyId = b2CreateBody(demoData.worldId, &bodyDef);
-            entity->texture = demoData.boxTexture;
+            entity->texture = boxTexture;
             entity->extent = demoData.boxExtent;
             b2ShapeDef shapeDef = b2DefaultShapeDef();
             b2CreatePolygonShape(entity->bodyId, &shapeDef, &demoData.boxPolygon);
@@ -123,8 +125,8 @@ void Box2DPhysics::UpdateDemo(void) {
 }
 
 void Box2DPhysics::CleanupDemo(void) {
-    UnloadTexture(demoData.groundTexture);
-    UnloadTexture(demoData.boxTexture);
+    Assets().Release(demoData.groundTexture);
+    Assets().Release(demoData.boxTexture);
 }
 
 void Box2DPhysics::Startup(void) {
@@ -0,0 +1,26 @@
+#include "ChangeTick.h"
+#include <atomic>
+
+namespace ChangeTicks {
+
+namespace {
+std::atomic<Tick> currentTick{1};
+
+thread_local SystemRun run{};
+} // namespace
+
+Tick Now() { return run.active ? run.now : currentTick.load(std::memory_order_relaxed) + 1; }
+
+Tick LastRun() { return run.active ? run.lastRun : 0; }
+
+Tick BeginSystem(Tick lastRun, SystemRun &outer) {
+    outer = run;
+    run.active = true;
+    run.now = currentTick.fetch_add(1, std::memory_order_relaxed) + 1;
+    run.lastRun = lastRun;
+    return run.now;
+}
+
+void EndSystem(const SystemRun &outer) { run = outer; }
+
+} // namespace ChangeTicks
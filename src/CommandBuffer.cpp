@@ -0,0 +1,35 @@
+#include "CommandBuffer.h"
+#include "Scene.h"
+
+void CommandBuffer::Playback(Scene &scene) {
+    _created.clear();
+    _touched.clear();
+
+    for (auto &command : _commands) {
+        if (command.op == Op::Create) {
+            _created.push_back(scene.CreateEntity());
+            continue;
+        }
+
+        Entity entity = command.pending ? _created[command.target] : command.target;
+        if (!scene.IsAlive(entity))
+            continue;
+
+        if (command.op == Op::Destroy) {
+            scene.DestroyEntity(entity);
+        } else {
+            command.apply(scene, entity, _data.data() + command.offset);
+            _touched.push_back(entity);
+        }
+    }
+
+    // Entities touched several times only change membership on their first commit
+    for (Entity entity : _touched) {
+        if (scene.IsAlive(entity))
+            scene.CommitSignature(entity);
+    }
+
+    _commands.clear();
+    _data.clear();
+    _pendingCount = 0;
+}
@@ -0,0 +1,713 @@
+#include "Builder.h"
+#include "ComponentArray.h"
+#include "RendererSystem.h"
+#include "Scene.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <string>
+#include <typeinfo>
+#include <unordered_map>
+#include <vector>
+
+constexpr size_t BENCH_ENTITIES = 10000;
+constexpr int BENCH_ROUNDS = 100;
+
+// The hash map storage ComponentArray used before the sparse set, kept as a baseline.
+template <typename T> class MapComponentArray {
+  private:
+    std::array<T, BENCH_ENTITIES> _componentArray;
+    std::unordered_map<Entity, size_t> _entityToIndexMap;
+    std::unordered_map<size_t, Entity> _indexToEntityMap;
+    size_t size = 0;
+
+  public:
+    void InsertData(Entity entity, T component) {
+        size_t newIndex = size;
+        _entityToIndexMap[entity] = newIndex;
+        _indexToEntityMap[newIndex] = entity;
+        _componentArray[newIndex] = component;
+        size++;
+    }
+
+    void RemoveData(Entity entity) {
+        size_t indexOfRemovedEntity = _entityToIndexMap[entity];
+        size_t indexOfLastElement = size - 1;
+        _componentArray[indexOfRemovedEntity] = _componentArray[indexOfLastElement];
+
+        Entity entityOfLastElement = _indexToEntityMap[indexOfLastElement];
+        _entityToIndexMap[entityOfLastElement] = indexOfRemovedEntity;
+        _indexToEntityMap[indexOfRemovedEntity] = entityOfLastElement;
+
+        _entityToIndexMap.erase(entity);
+        _indexToEntityMap.erase(indexOfLastElement);
+
+        size--;
+    }
+
+    T &GetData(Entity entity) { return _componentArray[_entityToIndexMap[entity]]; }
+};
+
+class Timer {
+  private:
+    std::chrono::steady_clock::time_point _start = std::chrono::steady_clock::now();
+
+  public:
+    double ElapsedMs() const {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - _start).count();
+    }
+};
+
+static void Report(const char *name, double baselineMs, double currentMs) {
+    std::cout << "  " << name << ": maps " << baselineMs << " ms, sparse set " << currentMs << " ms (x"
+              << baselineMs / currentMs << ")" << std::endl;
+}
+
+// Runs the same insert / lookup / remove workload on both storages.
+template <template <typename> class Storage> struct StorageWorkload {
+    Storage<Position> positions;
+    Storage<Velocity> velocities;
+
+    double Insert(const std::vector<Entity> &entities) {
+        Timer timer;
+        for (Entity entity : entities) {
+            positions.InsertData(entity, Position{Vector2{(float)entity, 0.0f}});
+            velocities.InsertData(entity, Velocity{1.0f, 1.0f});
+        }
+        return timer.ElapsedMs();
+    }
+
+    // Same access pattern as VelocitySystem: two lookups per entity.
+    double Lookup(const std::vector<Entity> &entities) {
+        Timer timer;
+        for (int round = 0; round < BENCH_ROUNDS; round++) {
+            for (Entity entity : entities) {
+                auto &pos = positions.GetData(entity);
+                auto &velocity = velocities.GetData(entity);
+                pos.position.x += velocity.speedX;
+                pos.position.y += velocity.speedY;
+            }
+        }
+        return timer.ElapsedMs();
+    }
+
+    double Remove(const std::vector<Entity> &entities) {
+        Timer timer;
+        for (Entity entity : entities) {
+            positions.RemoveData(entity);
+            velocities.RemoveData(entity);
+        }
+        return timer.ElapsedMs();
+    }
+};
+
+static void BenchComponentStorage() {
+    std::vector<Entity> entities(BENCH_ENTITIES);
+    std::iota(entities.begin(), entities.end(), 0);
+
+    std::vector<Entity> shuffled = entities;
+    std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(42));
+
+    auto maps = std::make_unique<StorageWorkload<MapComponentArray>>();
+    auto sparse = std::make_unique<StorageWorkload<ComponentArray>>();
+
+    std::cout << "Component storage, " << BENCH_ENTITIES << " entities x Position+Velocity" << std::endl;
+    Report("insert", maps->Insert(entities), sparse->Insert(entities));
+    Report("lookup (sequential)", maps->Lookup(entities), sparse->Lookup(entities));
+    Report("lookup (shuffled)", maps->Lookup(shuffled), sparse->Lookup(shuffled));
+    Report("remove (shuffled)", maps->Remove(shuffled), sparse->Remove(shuffled));
+
+    // Packed iteration is only possible on the sparse set.
+    for (Entity entity : entities)
+        sparse->positions.InsertData(entity, Position{Vector2{0.0f, 0.0f}});
+    Timer timer;
+    for (int round = 0; round < BENCH_ROUNDS; round++) {
+        for (size_t i = 0; i < sparse->positions.Size(); i++)
+            sparse->positions.At(i).position.x += 1.0f;
+    }
+    std::cout << "  packed iteration: sparse set " << timer.ElapsedMs() << " ms" << std::endl;
+}
+
+static void FillScene(Scene &scene, StorageBackend backend) {
+    scene.Init(backend);
+    scene.RegisterComponent<Position>();
+    scene.RegisterComponent<Velocity>();
+    scene.RegisterComponent<AnimationComponent>();
+    scene.RegisterComponent<MissileTag>();
+    scene.RegisterComponent<LocalPlayerTag>();
+
+    for (size_t i = 0; i < BENCH_ENTITIES; i++) {
+        Entity entity = scene.CreateEntity();
+        scene.AddComponent(entity, Position{Vector2{(float)i, 0.0f}});
+        scene.AddComponent(entity, Velocity{1.0f, 0.5f});
+        scene.AddComponent(entity, AnimationComponent{Rectangle{0, 0, 0, 0}, {}, 0, 0, 8});
+        if (i % 4 == 0)
+            scene.AddComponent(entity, MissileTag{});
+    }
+}
+
+static double IterateScene(Scene &scene) {
+    Timer timer;
+    for (int round = 0; round < BENCH_ROUNDS; round++) {
+        scene.View<Position, Velocity, AnimationComponent>().Each(
+            [](Position &pos, Velocity &velocity, AnimationComponent &anim) {
+                pos.position.x += velocity.speedX;
+                pos.position.y += velocity.speedY;
+                anim._frameCounter++;
+            });
+    }
+    return timer.ElapsedMs();
+}
+
+// Adds then removes a tag on every entity, which moves it between archetypes.
+static double ToggleTag(Scene &scene) {
+    Timer timer;
+    for (Entity entity = 0; entity < BENCH_ENTITIES; entity++)
+        scene.AddComponent(entity, LocalPlayerTag{});
+    for (Entity entity = 0; entity < BENCH_ENTITIES; entity++)
+        scene.RemoveComponent<LocalPlayerTag>(entity);
+    return timer.ElapsedMs();
+}
+
+static void BenchArchetypeStorage() {
+    auto sparse = std::make_unique<Scene>();
+    auto archetype = std::make_unique<Scene>();
+
+    std::cout << "Scene storage backends, " << BENCH_ENTITIES << " entities x Position+Velocity+AnimationComponent"
+              << std::endl;
+
+    Timer sparseFill;
+    FillScene(*sparse, StorageBackend::SparseSet);
+    double sparseFillMs = sparseFill.ElapsedMs();
+    Timer archetypeFill;
+    FillScene(*archetype, StorageBackend::Archetype);
+    double archetypeFillMs = archetypeFill.ElapsedMs();
+
+    std::cout << "  spawn: sparse set " << sparseFillMs << " ms, archetype " << archetypeFillMs << " ms" << std::endl;
+    std::cout << "  view iteration: sparse set " << IterateScene(*sparse) << " ms, archetype " << IterateScene(*archetype)
+              << " ms" << std::endl;
+    std::cout << "  add/remove tag: sparse set " << ToggleTag(*sparse) << " ms, archetype " << ToggleTag(*archetype) << " ms"
+              << std::endl;
+
+    std::cout << "  component memory: sparse set " << sparse->ComponentMemoryUsage() / 1024 << " KB, archetype "
+              << archetype->ComponentMemoryUsage() / 1024 << " KB" << std::endl;
+}
+
+// Storage grows with the live entity count instead of reserving MAX_ENTITIES per type.
+static void BenchCapacity() {
+    std::cout << "Capacity" << std::endl;
+
+    for (size_t count : {size_t(50), size_t(10000), size_t(50000)}) {
+        auto scene = std::make_unique<Scene>();
+        scene->Init();
+        scene->RegisterComponent<Position>();
+        scene->RegisterComponent<Velocity>();
+        scene->RegisterComponent<AnimationComponent>();
+        scene->RegisterComponent<Collider>();
+        scene->RegisterComponent<MissileTag>();
+
+        Timer timer;
+        for (size_t i = 0; i < count; i++) {
+            Entity entity = scene->CreateEntity();
+            scene->AddComponent(entity, Position{Vector2{(float)i, 0.0f}});
+            scene->AddComponent(entity, Velocity{1.0f, 0.0f});
+            scene->AddComponent(entity, MissileTag{});
+        }
+        std::cout << "  " << count << " entities: spawn " << timer.ElapsedMs() << " ms, component memory "
+                  << scene->ComponentMemoryUsage() / 1024 << " KB" << std::endl;
+    }
+}
+
+// Stand-ins for the demo systems: same signatures, no work in Update().
+template <int N> struct BenchSystem : public System {
+    void Update() override {}
+};
+
+static void RegisterDemoSystems(Scene &scene) {
+    scene.RegisterComponent<Position>();
+    scene.RegisterComponent<Velocity>();
+    scene.RegisterComponent<AnimationComponent>();
+    scene.RegisterComponent<Sprite>();
+    scene.RegisterComponent<Collider>();
+    scene.RegisterComponent<Tag>();
+    scene.RegisterComponent<InputController>();
+    scene.RegisterComponent<playerCooldown>();
+    scene.RegisterComponent<LocalPlayerTag>();
+    scene.RegisterComponent<CameraComponent>();
+
+    scene.RegisterSystem<BenchSystem<0>>();
+    scene.RegisterSystem<BenchSystem<1>>();
+    scene.RegisterSystem<BenchSystem<2>>();
+    scene.RegisterSystem<BenchSystem<3>>();
+    scene.RegisterSystem<BenchSystem<4>>();
+    scene.RegisterSystem<BenchSystem<5>>();
+
+    MiniBuilder::SystemBuilder(Signature{}).BuildSignature<BenchSystem<0>, Position, InputController>(scene);
+    MiniBuilder::SystemBuilder(Signature{}).BuildSignature<BenchSystem<1>, Position, Collider>(scene);
+    MiniBuilder::SystemBuilder(Signature{}).BuildSignature<BenchSystem<2>, Position, Velocity>(scene);
+    MiniBuilder::SystemBuilder(Signature{}).BuildSignature<BenchSystem<3>, Position, Sprite, AnimationComponent>(scene);
+    MiniBuilder::SystemBuilder(Signature{}).BuildSignature<BenchSystem<4>, CameraComponent>(scene);
+    MiniBuilder::SystemBuilder(Signature{}).BuildSignature<BenchSystem<5>, CameraComponent>(scene);
+}
+
+enum class SpawnMode { OneByOne, Builder, Prefab };
+
+// Spawns player-shaped entities one AddComponent at a time, through EntityBuilder or from a PrefabTemplate.
+static double SpawnPlayers(SpawnMode mode) {
+    auto scene = std::make_unique<Scene>();
+    scene->Init();
+    RegisterDemoSystems(*scene);
+
+    PrefabTemplate prefab = scene->MakePrefab(Position{}, InputController{}, AnimationComponent{Rectangle{0, 30, 32, 22}},
+                                              Tag{true}, Sprite{WHITE}, playerCooldown{false},
+                                              Collider{Rectangle{0, 30, 32, 22}, true}, Velocity{0, 0}, LocalPlayerTag{});
+
+    Timer timer;
+    for (size_t i = 0; i < BENCH_ENTITIES; i++) {
+        Position position{Vector2{(float)i, 0.0f}};
+        AnimationComponent animation{Rectangle{0, 30, 32, 22}};
+        Collider collider{Rectangle{0, 30, 32, 22}, true};
+
+        if (mode == SpawnMode::Prefab) {
+            scene->Instantiate(prefab, position);
+            continue;
+        }
+
+        Entity entity = scene->CreateEntity();
+        if (mode == SpawnMode::Builder) {
+            MiniBuilder::EntityBuilder(entity).BuildEntity(*scene, position, InputController{}, animation, Tag{true},
+                                                           Sprite{WHITE}, playerCooldown{false}, collider, Velocity{0, 0},
+                                                           LocalPlayerTag{});
+        } else {
+            scene->AddComponent(entity, position);
+            scene->AddComponent(entity, InputController{});
+            scene->AddComponent(entity, animation);
+            scene->AddComponent(entity, Tag{true});
+            scene->AddComponent(entity, Sprite{WHITE});
+            scene->AddComponent(entity, playerCooldown{false});
+            scene->AddComponent(entity, collider);
+            scene->AddComponent(entity, Velocity{0, 0});
+            scene->AddComponent(entity, LocalPlayerTag{});
+        }
+    }
+    return timer.ElapsedMs();
+}
+
+static void BenchSpawn() {
+    std::cout << "Spawn throughput, " << BENCH_ENTITIES << " players x 9 components, 6 systems" << std::endl;
+
+    double singleMs = SpawnPlayers(SpawnMode::OneByOne);
+    double batchedMs = SpawnPlayers(SpawnMode::Builder);
+    double prefabMs = SpawnPlayers(SpawnMode::Prefab);
+    std::cout << "  AddComponent one by one " << singleMs << " ms, EntityBuilder " << batchedMs << " ms (x"
+              << singleMs / batchedMs << "), PrefabTemplate " << prefabMs << " ms (x" << singleMs / prefabMs << ")"
+              << std::endl;
+}
+
+// Cost of resolving a component type: the old typeid().name() string map against the TypeId table.
+static void BenchTypeLookup() {
+    auto scene = std::make_unique<Scene>();
+    scene->Init();
+    scene->RegisterComponent<Position>();
+    scene->RegisterComponent<Velocity>();
+
+    std::unordered_map<std::string, ComponentType> names{{typeid(Position).name(), 0}, {typeid(Velocity).name(), 1}};
+    size_t lookups = BENCH_ENTITIES * BENCH_ROUNDS;
+    size_t sink = 0;
+
+    Timer mapTimer;
+    for (size_t i = 0; i < lookups; i++)
+        sink += names[i % 2 ? typeid(Position).name() : typeid(Velocity).name()];
+    double mapMs = mapTimer.ElapsedMs();
+
+    Timer idTimer;
+    for (size_t i = 0; i < lookups; i++)
+        sink += i % 2 ? scene->GetComponentType<Position>() : scene->GetComponentType<Velocity>();
+    double idMs = idTimer.ElapsedMs();
+
+    std::cout << "Component type lookup, " << lookups << " calls (" << sink % 2 << ")" << std::endl;
+    std::cout << "  typeid string map " << mapMs << " ms, TypeId " << idMs << " ms (x" << mapMs / idMs << ")" << std::endl;
+}
+
+// Touches one component type for every entity owning it.
+template <typename T, typename Func> struct WorkSystem : public System {
+    Scene *scene = nullptr;
+
+    void Update() override {
+        for (int round = 0; round < 20; round++)
+            scene->View<T>().Each(Func{});
+    }
+};
+
+struct MovePosition {
+    void operator()(Position &pos) { pos.position.x += 1.0f; }
+};
+struct DampVelocity {
+    void operator()(Velocity &velocity) { velocity.speedX *= 0.99f; }
+};
+struct ShiftCollider {
+    void operator()(Collider &collider) { collider.rect.x += 0.5f; }
+};
+struct TickAnimation {
+    void operator()(AnimationComponent &anim) { anim._frameCounter++; }
+};
+
+using PositionWork = WorkSystem<Position, MovePosition>;
+using VelocityWork = WorkSystem<Velocity, DampVelocity>;
+using ColliderWork = WorkSystem<Collider, ShiftCollider>;
+using AnimationWork = WorkSystem<AnimationComponent, TickAnimation>;
+
+static double RunSystems(bool declareAccess, bool printTimeline) {
+    auto scene = std::make_unique<Scene>();
+    scene->Init();
+    scene->RegisterComponent<Position>();
+    scene->RegisterComponent<Velocity>();
+    scene->RegisterComponent<Collider>();
+    scene->RegisterComponent<AnimationComponent>();
+
+    scene->RegisterSystem<PositionWork>()->scene = scene.get();
+    scene->RegisterSystem<VelocityWork>()->scene = scene.get();
+    scene->RegisterSystem<ColliderWork>()->scene = scene.get();
+    scene->RegisterSystem<AnimationWork>()->scene = scene.get();
+    if (declareAccess) {
+        MiniBuilder::AccessBuilder().Write<Position>(*scene).BuildAccess<PositionWork>(*scene);
+        MiniBuilder::AccessBuilder().Write<Velocity>(*scene).BuildAccess<VelocityWork>(*scene);
+        MiniBuilder::AccessBuilder().Write<Collider>(*scene).BuildAccess<ColliderWork>(*scene);
+        MiniBuilder::AccessBuilder().Write<AnimationComponent>(*scene).BuildAccess<AnimationWork>(*scene);
+    }
+
+    for (size_t i = 0; i < BENCH_ENTITIES * 10; i++) {
+        Entity entity = scene->CreateEntity();
+        scene->AddComponents(entity, Position{Vector2{(float)i, 0.0f}}, Velocity{1.0f, 0.0f},
+                             Collider{Rectangle{0, 0, 8, 8}, false}, AnimationComponent{Rectangle{0, 0, 0, 0}, {}, 0, 0, 8});
+    }
+
+    scene->UpdateAllSystem(); // builds the schedule
+    Timer timer;
+    for (int frame = 0; frame < 10; frame++)
+        scene->UpdateAllSystem();
+    double elapsed = timer.ElapsedMs();
+
+    if (printTimeline) {
+        for (auto &timing : scene->GetFrameTimeline())
+            std::cout << "    worker " << timing.worker << " " << timing.startMs << "-" << timing.endMs << " ms" << std::endl;
+    }
+    return elapsed;
+}
+
+static void BenchScheduler() {
+    std::cout << "System scheduler, 4 systems with disjoint writes, " << BENCH_ENTITIES * 10 << " entities, "
+              << Roar::Jobs().WorkerCount() << " workers" << std::endl;
+
+    double serialMs = RunSystems(false, false);
+    double parallelMs = RunSystems(true, true);
+    std::cout << "  10 frames: serial " << serialMs << " ms, scheduled " << parallelMs << " ms (x" << serialMs / parallelMs
+              << ")" << std::endl;
+}
+
+// VelocitySystem's loop, on the calling thread and split across the job pool.
+static void BenchParallelEach() {
+    std::cout << "ParallelEach, Position+Velocity, " << Roar::Jobs().WorkerCount() << " workers + main thread" << std::endl;
+
+    for (StorageBackend backend : {StorageBackend::SparseSet, StorageBackend::Archetype}) {
+        for (size_t count : {size_t(10000), size_t(100000), size_t(1000000)}) {
+            auto scene = std::make_unique<Scene>();
+            scene->Init(backend);
+            scene->RegisterComponent<Position>();
+            scene->RegisterComponent<Velocity>();
+            for (size_t i = 0; i < count; i++)
+                scene->AddComponents(scene->CreateEntity(), Position{Vector2{(float)i, 0.0f}}, Velocity{1.0f, 0.5f});
+
+            auto move = [](Position &pos, Velocity &velocity) {
+                pos.position.x += velocity.speedX;
+                pos.position.y += velocity.speedY;
+            };
+            int frames = static_cast<int>(std::max<size_t>(1, 10000000 / count));
+
+            Timer serial;
+            for (int frame = 0; frame < frames; frame++)
+                scene->View<Position, Velocity>().Each(move);
+            double serialMs = serial.ElapsedMs() / frames;
+
+            Timer parallel;
+            for (int frame = 0; frame < frames; frame++)
+                scene->View<Position, Velocity>().ParallelEach(move);
+            double parallelMs = parallel.ElapsedMs() / frames;
+
+            std::cout << "  " << (backend == StorageBackend::Archetype ? "archetype " : "sparse set ") << count
+                      << " entities: Each " << serialMs << " ms, ParallelEach " << parallelMs << " ms per frame (x"
+                      << serialMs / parallelMs << ")" << std::endl;
+        }
+    }
+}
+
+// Missiles spawned and destroyed through the command buffers, destruction recorded from ParallelEach.
+static void BenchCommandBuffer() {
+    auto scene = std::make_unique<Scene>();
+    scene->Init();
+    RegisterDemoSystems(*scene);
+    scene->RegisterComponent<MissileTag>();
+
+    Timer spawn;
+    for (size_t i = 0; i < BENCH_ENTITIES; i++) {
+        auto missile = scene->Commands().CreateEntity();
+        scene->Commands().AddComponents(missile, Position{Vector2{(float)(i % 1600), 0.0f}},
+                                        AnimationComponent{Rectangle{0, 128, 25, 22}, {}, 0, 0, 8}, Sprite{RED}, Tag{false},
+                                        MissileTag{});
+    }
+    scene->FlushCommands();
+    double spawnMs = spawn.ElapsedMs();
+
+    Timer destroy;
+    scene->View<Position, MissileTag>().ParallelEach([&](Entity entity, Position &pos, MissileTag &) {
+        if (pos.position.x > 800)
+            scene->Commands().DestroyEntity(entity);
+    });
+    scene->FlushCommands();
+    double destroyMs = destroy.ElapsedMs();
+
+    size_t left = 0;
+    scene->View<MissileTag>().Each([&](MissileTag &) { left++; });
+    std::cout << "Command buffer, " << BENCH_ENTITIES << " missiles" << std::endl;
+    std::cout << "  spawn " << spawnMs << " ms, destroy half from ParallelEach " << destroyMs << " ms, "
+              << left << " left" << std::endl;
+}
+
+// A burst of missiles spawned and destroyed one entity at a time, then through CreateEntities/DestroyEntities.
+static void BenchMissileBurst() {
+    Position position{Vector2{0.0f, 0.0f}};
+    AnimationComponent animation{Rectangle{0, 128, 25, 22}, {}, 0, 0, 8};
+
+    for (auto backend : {StorageBackend::SparseSet, StorageBackend::Archetype}) {
+        double spawnMs[2];
+        double destroyMs[2];
+
+        for (int batched = 0; batched < 2; batched++) {
+            auto scene = std::make_unique<Scene>();
+            scene->Init(backend);
+            RegisterDemoSystems(*scene);
+            scene->RegisterComponent<MissileTag>();
+
+            std::vector<Entity> missiles;
+            Timer spawn;
+            if (batched) {
+                missiles = scene->CreateEntities(BENCH_ENTITIES, position, animation, Sprite{RED}, Tag{false}, MissileTag{});
+            } else {
+                for (size_t i = 0; i < BENCH_ENTITIES; i++) {
+                    Entity missile = scene->CreateEntity();
+                    scene->AddComponents(missile, position, animation, Sprite{RED}, Tag{false}, MissileTag{});
+                    missiles.push_back(missile);
+                }
+            }
+            spawnMs[batched] = spawn.ElapsedMs();
+
+            Timer destroy;
+            if (batched) {
+                scene->DestroyEntities(missiles);
+            } else {
+                for (Entity missile : missiles)
+                    scene->DestroyEntity(missile);
+            }
+            destroyMs[batched] = destroy.ElapsedMs();
+        }
+
+        std::cout << "Missile burst (" << (backend == StorageBackend::Archetype ? "archetype" : "sparse set") << "), "
+                  << BENCH_ENTITIES << " missiles x 5 components, 6 systems" << std::endl;
+        std::cout << "  spawn one by one " << spawnMs[0] << " ms, CreateEntities " << spawnMs[1] << " ms (x"
+                  << spawnMs[0] / spawnMs[1] << ")" << std::endl;
+        std::cout << "  destroy one by one " << destroyMs[0] << " ms, DestroyEntities " << destroyMs[1] << " ms (x"
+                  << destroyMs[0] / destroyMs[1] << ")" << std::endl;
+    }
+}
+
+// Collider sync over every collider against only the ones whose position changed, 1% of them moving per frame.
+static void BenchChangeDetection() {
+    for (auto backend : {StorageBackend::SparseSet, StorageBackend::Archetype}) {
+        auto scene = std::make_unique<Scene>();
+        scene->Init(backend);
+        scene->RegisterComponent<Position>();
+        scene->RegisterComponent<Collider>();
+
+        std::vector<Entity> entities;
+        for (size_t i = 0; i < BENCH_ENTITIES; i++) {
+            Entity entity = scene->CreateEntity();
+            scene->AddComponents(entity, Position{Vector2{(float)i, 0.0f}}, Collider{Rectangle{0, 0, 16, 16}, false});
+            entities.push_back(entity);
+        }
+
+        auto sync = [](const Position &pos, Collider &collider) {
+            collider.rect.x = pos.position.x;
+            collider.rect.y = pos.position.y;
+        };
+        auto move = [&](int round) {
+            for (size_t i = round; i < BENCH_ENTITIES; i += 100) {
+                scene->GetComponent<Position>(entities[i]).position.y += 1.0f;
+                scene->MarkChanged<Position>(entities[i]);
+            }
+        };
+
+        Timer full;
+        for (int round = 0; round < BENCH_ROUNDS; round++) {
+            move(round);
+            scene->View<const Position, Collider>().Each(sync);
+        }
+        double fullMs = full.ElapsedMs();
+
+        // Each round stands for one run of a sync system, the first one having seen every collider
+        ChangeTicks::SystemRun outer;
+        Tick lastRun = ChangeTicks::BeginSystem(0, outer);
+        ChangeTicks::EndSystem(outer);
+        size_t synced = 0;
+        Timer changed;
+        for (int round = 0; round < BENCH_ROUNDS; round++) {
+            move(round);
+            lastRun = ChangeTicks::BeginSystem(lastRun, outer);
+            scene->View<const Position, Collider>().Changed<Position>().Each([&](const Position &pos, Collider &collider) {
+                sync(pos, collider);
+                synced++;
+            });
+            ChangeTicks::EndSystem(outer);
+        }
+        double changedMs = changed.ElapsedMs();
+
+        std::cout << "Change detection (" << (backend == StorageBackend::Archetype ? "archetype" : "sparse set") << "), "
+                  << BENCH_ENTITIES << " colliders, " << BENCH_ROUNDS << " rounds" << std::endl;
+        std::cout << "  sync all " << fullMs << " ms, sync Changed<Position> " << changedMs << " ms (" << synced
+                  << " synced)" << std::endl;
+    }
+}
+
+// The old RendererSystem loop, drawing each entity as it is reached with per entity lookups, against
+// extracting draw commands in one pass and submitting them sorted. Enemies and missiles alternate
+// between two textures and two layers; the null backend stands for the GPU.
+static void BenchRenderSubmit() {
+    Scene scene;
+    scene.Init();
+    scene.RegisterComponent<Position>();
+    scene.RegisterComponent<Sprite>();
+    scene.RegisterComponent<AnimationComponent>();
+    scene.RegisterComponent<CameraComponent>();
+
+    std::vector<Entity> entities;
+    for (size_t i = 0; i < BENCH_ENTITIES; i++) {
+        Entity entity = scene.CreateEntity();
+        bool missile = i % 2;
+        Sprite sprite{missile ? RED : GREEN, Roar::TextureHandle{missile ? 1u : 2u},
+                      missile ? uint16_t{LAYER_MISSILES} : uint16_t{LAYER_ENEMIES}};
+        scene.AddComponents(entity, Position{Vector2{(float)i, 0.0f}}, sprite,
+                            AnimationComponent{Rectangle{0, 128, 25, 22}, {}, 0, 0, 8});
+        entities.push_back(entity);
+    }
+
+    Roar::NullRenderBackend immediate;
+    Timer perEntity;
+    for (int round = 0; round < BENCH_ROUNDS; round++) {
+        for (Entity entity : entities) {
+            auto &pos = scene.GetComponent<Position>(entity);
+            auto &sprite = scene.GetComponent<Sprite>(entity);
+            auto &anim = scene.GetComponent<AnimationComponent>(entity);
+            const CameraComponent *cam =
+                scene.HasComponent<CameraComponent>(entity) ? &scene.GetComponent<CameraComponent>(entity) : nullptr;
+            Roar::DrawCommand command{Roar::DrawCommand::MakeKey(sprite.texture, sprite.layer), anim.rect,
+                                      SpriteDestination(pos, anim, cam), sprite.color};
+            immediate.DrawSprites(sprite.texture, std::span<const Roar::DrawCommand>(&command, 1));
+        }
+    }
+    double perEntityMs = perEntity.ElapsedMs();
+
+    Roar::SpriteBatch batch;
+    Roar::NullRenderBackend sorted;
+    double extractMs = 0.0;
+    double submitMs = 0.0;
+    for (int round = 0; round < BENCH_ROUNDS; round++) {
+        Timer extract;
+        ExtractSprites(scene, batch);
+        extractMs += extract.ElapsedMs();
+        Timer submit;
+        batch.Flush(sorted);
+        submitMs += submit.ElapsedMs();
+    }
+
+    std::cout << "Render submit, " << BENCH_ENTITIES << " sprites on 2 textures, " << BENCH_ROUNDS << " frames" << std::endl;
+    std::cout << "  per entity " << perEntityMs << " ms (" << immediate.batches / BENCH_ROUNDS << " batches a frame), extract "
+              << extractMs << " ms + sorted submit " << submitMs << " ms (" << sorted.batches / BENCH_ROUNDS
+              << " batches a frame)" << std::endl;
+}
+
+// Extracting every sprite of a level twenty screens wide against keeping a spatial grid in sync and
+// extracting the ones on screen, a tenth of the sprites moving each frame.
+static void BenchCulling() {
+    Scene scene;
+    scene.Init();
+    scene.RegisterComponent<Position>();
+    scene.RegisterComponent<Sprite>();
+    scene.RegisterComponent<AnimationComponent>();
+    scene.RegisterComponent<CameraComponent>();
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> levelX(0.0f, GAME_WIDTH * 20.0f);
+    std::uniform_real_distribution<float> levelY(0.0f, GAME_HEIGHT);
+    std::vector<Entity> entities;
+    for (size_t i = 0; i < BENCH_ENTITIES; i++) {
+        Entity entity = scene.CreateEntity();
+        scene.AddComponents(entity, Position{Vector2{levelX(rng), levelY(rng)}}, Sprite{WHITE},
+                            AnimationComponent{Rectangle{0, 128, 25, 22}, {}, 0, 0, 8});
+        entities.push_back(entity);
+    }
+    auto move = [&](int round) {
+        for (size_t i = round % 10; i < BENCH_ENTITIES; i += 10) {
+            scene.GetComponent<Position>(entities[i]).position.x -= 1.0f;
+            scene.MarkChanged<Position>(entities[i]);
+        }
+    };
+
+    Roar::SpriteBatch batch;
+    Roar::NullRenderBackend all;
+    Timer full;
+    for (int round = 0; round < BENCH_ROUNDS; round++) {
+        move(round);
+        ExtractSprites(scene, batch);
+        batch.Flush(all);
+    }
+    double fullMs = full.ElapsedMs();
+
+    // Each round stands for one run of the renderer
+    SpatialGrid grid;
+    Roar::NullRenderBackend visible;
+    Rectangle screen{0.0f, 0.0f, GAME_WIDTH, GAME_HEIGHT};
+    Tick lastRun = 0;
+    ChangeTicks::SystemRun outer;
+    Timer culled;
+    for (int round = 0; round < BENCH_ROUNDS; round++) {
+        move(round);
+        lastRun = ChangeTicks::BeginSystem(lastRun, outer);
+        IndexSprites(scene, grid);
+        ExtractVisibleSprites(scene, grid, screen, batch);
+        ChangeTicks::EndSystem(outer);
+        batch.Flush(visible);
+    }
+    double culledMs = culled.ElapsedMs();
+
+    std::cout << "Culling, " << BENCH_ENTITIES << " sprites over 20 screens, " << BENCH_ROUNDS << " frames" << std::endl;
+    std::cout << "  draw all " << fullMs << " ms (" << all.sprites / BENCH_ROUNDS << " sprites a frame), grid " << culledMs
+              << " ms (" << visible.sprites / BENCH_ROUNDS << " sprites a frame)" << std::endl;
+}
+
+int main() {
+    BenchComponentStorage();
+    BenchArchetypeStorage();
+    BenchCapacity();
+    BenchSpawn();
+    BenchTypeLookup();
+    BenchScheduler();
+    BenchParallelEach();
+    BenchCommandBuffer();
+    BenchChangeDetection();
+    BenchMissileBurst();
+    BenchRenderSubmit();
+    BenchCulling();
+    return 0;
+}
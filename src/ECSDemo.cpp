@@ -40,6 +40,7 @@ int main() {
     cameraFollowSystem->order = 6;
     auto renderSystem = _core.RegisterSystem<RendererSystem>();
     renderSystem->order = 7;
+    renderSystem->SetScreenSize(screenWidth, screenHeight);
     Signature gravitySignature;
     Signature inputControllerSignature;
     Signature missileSystemSignature;
@@ -70,9 +71,22 @@ int main() {
     MiniBuilder::SystemBuilder cameraFollowBuilder(cameraFollowSignature);
     cameraFollowBuilder.BuildSignature<CameraFollowSystem, CameraComponent>(_core);
 
+    // Systems whose writes do not overlap run concurrently, e.g. CameraSystem next to MissileSystem
+    MiniBuilder::AccessBuilder().Read<InputController, PlayerSprite>(_core).Write<Position, Velocity, playerCooldown>(_core)
+        .BuildAccess<InputControllerSystem>(_core);
+    MiniBuilder::AccessBuilder().Read<MissileTag>(_core).Write<Position, AnimationComponent>(_core).BuildAccess<MissileSystem>(_core);
+    MiniBuilder::AccessBuilder().Write<Position, Collider>(_core).BuildAccess<CollisionSystem>(_core);
+    MiniBuilder::AccessBuilder().Read<Velocity>(_core).Write<Position>(_core).BuildAccess<VelocitySystem>(_core);
+    MiniBuilder::AccessBuilder().Write<CameraComponent>(_core).BuildAccess<CameraSystem>(_core);
+    MiniBuilder::AccessBuilder().Read<Position, LocalPlayerTag>(_core).Write<CameraComponent>(_core).BuildAccess<CameraFollowSystem>(_core);
+    MiniBuilder::AccessBuilder().Read<Position, Sprite, AnimationComponent, CameraComponent>(_core)
+        .BuildAccess<RendererSystem>(_core);
+
     // Entity camera = Prefab::MakeCamera(_core);
-    Entity player = Prefab::MakePlayer(_core, (float)screenWidth/2, (float)screenHeight/2);
-    Entity enemy = Prefab::MakeEnemy(_core, (float)300, (float)200);
+    PrefabTemplate playerPrefab = Prefab::PlayerTemplate(_core);
+    PrefabTemplate enemyPrefab = Prefab::EnemyTemplate(_core);
+    Entity player = Prefab::MakePlayer(_core, playerPrefab, (float)screenWidth/2, (float)screenHeight/2);
+    Entity enemy = Prefab::MakeEnemy(_core, enemyPrefab, (float)300, (float)200);
 
     PyhsicEngine _physicCore(*colliderSystem, *velocitySystem);
 
@@ -80,8 +94,25 @@ int main() {
 
     while (!WindowShouldClose()) {
         _core.UpdateAllSystem();
+
+        BeginDrawing();
+        ClearBackground(LIGHTGRAY);
+        renderSystem->Submit();
+        EndDrawing();
+
+        if (IsKeyPressed(KEY_F1)) {
+            for (auto &timing : _core.GetFrameTimeline())
+                std::cout << "worker " << timing.worker << " " << timing.startMs << "-" << timing.endMs << " ms " << timing.name
+                          << std::endl;
+            const Roar::AssetStats &assets = Roar::Assets().GetStats();
+            std::cout << "textures " << assets.textureCount << " (" << assets.textureBytes / 1024 << " KB), " << assets.loads
+                      << " loads in " << assets.loadMs << " ms, " << assets.cacheHits << " cache hits" << std::endl;
+            const Roar::SpriteBatchStats &sprites = renderSystem->GetBatchStats();
+            std::cout << "sprites " << sprites.sprites << " in " << sprites.batches << " batches" << std::endl;
+        }
     }
-    
+
+    Roar::Assets().Clear();
     CloseWindow();
 
     return 0;
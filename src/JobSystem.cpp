@@ -0,0 +1,127 @@
+#include "JobSystem.h"
+
+#include <algorithm>
+
+namespace Roar {
+
+namespace {
+thread_local uint32_t currentWorker = 0;
+}
+
+JobSystem::JobSystem(uint32_t workerCount)
+    : _workerCount(workerCount), _queues(std::make_unique<WorkQueue[]>(workerCount + 1)) {
+    for (uint32_t i = 0; i < workerCount; i++)
+        _workers.emplace_back(&JobSystem::WorkerLoop, this, i + 1);
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(_sleepMutex);
+        _stopping = true;
+    }
+    _wake.notify_all();
+    for (auto &worker : _workers)
+        worker.join();
+}
+
+void JobSystem::Submit(Job job) { Push(CurrentWorker(), std::move(job)); }
+
+void JobSystem::ParallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)> &func) {
+    if (count == 0)
+        return;
+    if (grain == 0)
+        grain = std::max<size_t>(256, count / (QueueCount() * 4));
+
+    size_t chunks = (count + grain - 1) / grain;
+    if (chunks == 1 || _workerCount == 0) {
+        func(0, count);
+        return;
+    }
+
+    std::atomic<size_t> pending{chunks};
+    uint32_t self = CurrentWorker();
+
+    // Pushed last chunk first so the caller, popping from the back, starts at the beginning of the range.
+    for (size_t chunk = chunks; chunk-- > 0;) {
+        size_t begin = chunk * grain;
+        size_t end = std::min(count, begin + grain);
+
+        Push(self, [&func, &pending, begin, end] {
+            func(begin, end);
+            pending.fetch_sub(1, std::memory_order_release);
+        });
+    }
+    while (pending.load(std::memory_order_acquire) > 0) {
+        if (!TryRun(self))
+            std::this_thread::yield();
+    }
+}
+
+uint32_t JobSystem::CurrentWorker() { return currentWorker; }
+
+uint32_t JobSystem::DefaultWorkerCount() {
+    uint32_t threads = std::thread::hardware_concurrency();
+
+    return threads > 1 ? threads - 1 : 0;
+}
+
+void JobSystem::Push(uint32_t queue, Job job) {
+    {
+        std::lock_guard<std::mutex> lock(_queues[queue].mutex);
+        _queues[queue].jobs.push_back(std::move(job));
+    }
+    _queued.fetch_add(1, std::memory_order_release);
+    {
+        // Orders the increment with a worker checking it before going to sleep
+        std::lock_guard<std::mutex> lock(_sleepMutex);
+    }
+    _wake.notify_one();
+}
+
+bool JobSystem::TryRun(uint32_t self) {
+    Job job;
+
+    {
+        WorkQueue &own = _queues[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.jobs.empty()) {
+            job = std::move(own.jobs.back());
+            own.jobs.pop_back();
+        }
+    }
+    for (uint32_t i = 1; !job && i < QueueCount(); i++) {
+        WorkQueue &victim = _queues[(self + i) % QueueCount()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.jobs.empty()) {
+            job = std::move(victim.jobs.front());
+            victim.jobs.pop_front();
+        }
+    }
+    if (!job)
+        return false;
+
+    _queued.fetch_sub(1, std::memory_order_relaxed);
+    job();
+    return true;
+}
+
+void JobSystem::WorkerLoop(uint32_t worker) {
+    currentWorker = worker;
+
+    while (true) {
+        if (TryRun(worker))
+            continue;
+
+        std::unique_lock<std::mutex> lock(_sleepMutex);
+        _wake.wait(lock, [this] { return _stopping || _queued.load(std::memory_order_acquire) > 0; });
+        if (_stopping && _queued.load(std::memory_order_acquire) == 0)
+            return;
+    }
+}
+
+JobSystem &Jobs() {
+    static JobSystem jobs;
+    return jobs;
+}
+
+} // namespace Roar
@@ -0,0 +1,573 @@
+#include "Networking.h"
+#include "RoarEngine.h"
+#include "r-type.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <thread>
+#include <vector>
+
+// Heap allocations of the whole program, counted by the operator new below
+static std::atomic<size_t> allocations{0};
+
+void *operator new(size_t size) {
+    allocations++;
+    if (void *memory = malloc(size ? size : 1))
+        return memory;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *memory) noexcept { free(memory); }
+void operator delete(void *memory, size_t) noexcept { free(memory); }
+
+constexpr int BENCH_TICKS = 600;
+constexpr int BENCH_PACKETS = 20000;
+constexpr size_t BENCH_BATCH_CLIENTS = 64;
+constexpr int BENCH_BATCH_TICKS = 1000;
+constexpr int BENCH_LOOP_TICKS = 120;
+constexpr double BENCH_TICK_WORK_MS = 2.0;
+constexpr auto BENCH_PACKET_INTERVAL = std::chrono::milliseconds(7);
+constexpr uint16_t BENCH_PORT = PORT + 1;
+// Ticks between a snapshot reaching a client and its ack reaching the server
+constexpr int BENCH_ACK_DELAY = 3;
+
+// The byte aligned encoding the protocol used before bit packing, kept as a baseline: every field of
+// every missile, 4 bytes each.
+static void ByteSerializeMissile(Roar::INetBuffer &buffer, const Missile &missile) {
+    buffer.WriteFloat(missile.pos.x);
+    buffer.WriteFloat(missile.pos.y);
+    buffer.WriteFloat(missile.rect.x);
+    buffer.WriteFloat(missile.rect.y);
+    buffer.WriteFloat(missile.rect.width);
+    buffer.WriteFloat(missile.rect.height);
+    buffer.WriteUInt32(missile.currentFrame);
+    buffer.WriteUInt32(missile.framesSpeed);
+    buffer.WriteUInt32(missile.framesCounter);
+}
+
+static void ByteSerializeGameState(Roar::INetBuffer &buffer, const GameStateMessage &msg) {
+    buffer.WriteUInt32(msg.client_count);
+    for (unsigned int i = 0; i < msg.client_count; i++) {
+        const ClientState &client = msg.client_states[i];
+
+        buffer.WriteUInt32(client.client_id);
+        buffer.WriteInt32(client.x);
+        buffer.WriteInt32(client.y);
+        buffer.WriteUInt32(client.missile_count);
+        for (unsigned int j = 0; j < client.missile_count; j++)
+            ByteSerializeMissile(buffer, client.missiles[j]);
+    }
+    buffer.WriteFloat(msg.countdown_timer);
+    buffer.WriteUInt32(msg.current_wave);
+    buffer.WriteUInt8(msg.wave_active ? 1 : 0);
+}
+
+// What a client sends about itself, played the way the client does: ships drift up and down and fire
+// every tick their missile count allows, missiles fly right, animate and go away past the screen.
+static void SimulateClient(ClientState &client, int tick) {
+    Missile *end = std::remove_if(client.missiles, client.missiles + client.missile_count,
+                                  [](const Missile &missile) { return missile.pos.x > GAME_WIDTH; });
+    client.missile_count = (unsigned int)(end - client.missiles);
+
+    for (unsigned int i = 0; i < client.missile_count; i++) {
+        Missile &missile = client.missiles[i];
+
+        missile.framesCounter++;
+        if (missile.framesCounter >= (100 / missile.framesSpeed)) {
+            missile.framesCounter = 0;
+            missile.currentFrame = (missile.currentFrame + 1) % 5;
+            missile.rect = MISSILE_FRAMES[missile.currentFrame];
+        }
+        missile.pos.x += 5;
+    }
+
+    client.y = 50 + (tick + (int)client.client_id * 100) % (GAME_HEIGHT - 100);
+    if (client.missile_count < MAX_MISSILES_CLIENT) {
+        client.missiles[client.missile_count++] = Missile{Vector2{(float)client.x, (float)client.y}, MISSILE_FRAMES[0], 0, 8, 0};
+    }
+}
+
+// The game state once it went over the wire, positions rounded to their quantization step
+static GameStateMessage Transmitted(const GameStateMessage &state) {
+    Roar::NetBuffer buffer(Roar::MAX_DATAGRAM_SIZE);
+    SerializeGameStateMessage(buffer, state);
+    return DeserializeGameStateMessage(buffer);
+}
+
+static bool SameGameState(const GameStateMessage &a, const GameStateMessage &b) {
+    if (a.client_count != b.client_count || a.countdown_timer != b.countdown_timer || a.current_wave != b.current_wave ||
+        a.wave_active != b.wave_active)
+        return false;
+
+    for (unsigned int i = 0; i < a.client_count; i++) {
+        const ClientState &x = a.client_states[i];
+        const ClientState &y = b.client_states[i];
+
+        if (x.client_id != y.client_id || x.x != y.x || x.y != y.y || x.missile_count != y.missile_count ||
+            memcmp(x.missiles, y.missiles, x.missile_count * sizeof(Missile)) != 0)
+            return false;
+    }
+    return true;
+}
+
+// One client of the loopback test: its socket, what it decoded and what the server knows of its acks
+struct Receiver {
+    Roar::NetClient socket;
+    sockaddr_in address;
+    SnapshotHistory snapshots;
+    uint32_t received = NO_SNAPSHOT;
+    uint32_t acks[BENCH_ACK_DELAY] = {NO_SNAPSHOT, NO_SNAPSHOT, NO_SNAPSHOT}; // in flight to the server
+    uint32_t acked = NO_SNAPSHOT;
+};
+
+// The broadcast of the server, over loopback sockets, every client sending its full share of missiles.
+static void BenchSnapshots() {
+    Roar::NetServer server(BENCH_PORT);
+    if (!server.Start()) {
+        std::cout << "Snapshots: cannot bind port " << BENCH_PORT << std::endl;
+        return;
+    }
+
+    std::vector<Receiver> receivers(MAX_CLIENTS);
+    Roar::NetBuffer buffer(Roar::MAX_DATAGRAM_SIZE);
+    sockaddr_in from;
+
+    // Each client says hello so the server learns its address
+    for (size_t i = 0; i < receivers.size(); i++) {
+        receivers[i].socket.Connect("127.0.0.1", BENCH_PORT);
+        ClearSnapshots(receivers[i].snapshots);
+        buffer.Clear();
+        buffer.WriteUInt8((uint8_t)i);
+        receivers[i].socket.Send(buffer);
+    }
+    for (size_t i = 0; i < receivers.size(); i++) {
+        buffer.Clear();
+        while (server.Receive(buffer, from) <= 0)
+            ;
+        receivers[buffer.ReadUInt8()].address = from;
+    }
+
+    auto sent = std::make_unique<SnapshotHistory>();
+    auto game = std::make_unique<GameStateMessage>();
+    ClearSnapshots(*sent);
+    *game = {};
+    game->client_count = MAX_CLIENTS;
+    for (unsigned int i = 0; i < MAX_CLIENTS; i++) {
+        game->client_states[i].client_id = i + 1;
+        game->client_states[i].x = 50 + (int)i * 20;
+    }
+
+    size_t byteBytes = 0;
+    size_t fullBytes = 0;
+    size_t deltaBytes = 0;
+    int fullSnapshots = 0;
+    bool mismatch = false;
+    for (int tick = 0; tick < BENCH_TICKS; tick++) {
+        for (unsigned int i = 0; i < MAX_CLIENTS; i++)
+            SimulateClient(game->client_states[i], tick);
+        StoreSnapshot(*sent, tick, *game);
+        GameStateMessage expected = Transmitted(*game);
+
+        for (Receiver &receiver : receivers) {
+            buffer.Clear();
+            buffer.WriteUInt8(MSG_GAME_STATE);
+            ByteSerializeGameState(buffer, *game);
+            byteBytes += buffer.GetSize();
+
+            buffer.Clear();
+            buffer.WriteUInt8(MSG_GAME_STATE);
+            SerializeGameStateMessage(buffer, *game);
+            fullBytes += buffer.GetSize();
+
+            const GameStateMessage *base = FindSnapshot(*sent, receiver.acked);
+            fullSnapshots += base == nullptr;
+            buffer.Clear();
+            buffer.WriteUInt8(MSG_GAME_STATE);
+            SerializeGameStateDelta(buffer, tick, *game, receiver.acked, base);
+            deltaBytes += buffer.GetSize();
+            server.SendTo(buffer, receiver.address);
+        }
+
+        for (Receiver &receiver : receivers) {
+            uint32_t snapshotTick;
+            uint32_t baseTick;
+
+            buffer.Clear();
+            while (receiver.socket.Receive(buffer) > 0) {
+                buffer.ReadUInt8();
+                DeserializeSnapshotHeader(buffer, snapshotTick, baseTick);
+                GameStateMessage decoded = DeserializeGameStateDelta(buffer, FindSnapshot(receiver.snapshots, baseTick));
+
+                mismatch |= !SameGameState(decoded, expected);
+                StoreSnapshot(receiver.snapshots, snapshotTick, decoded);
+                receiver.received = snapshotTick;
+                buffer.Clear();
+            }
+
+            // The ack rides the next state update of the client
+            receiver.acked = receiver.acks[tick % BENCH_ACK_DELAY] != NO_SNAPSHOT ? receiver.acks[tick % BENCH_ACK_DELAY]
+                                                                                  : receiver.acked;
+            receiver.acks[tick % BENCH_ACK_DELAY] = receiver.received;
+        }
+    }
+
+    std::cout << "Snapshots, " << MAX_CLIENTS << " clients x " << MAX_MISSILES_CLIENT << " missiles, " << BENCH_TICKS
+              << " ticks over loopback" << std::endl;
+    std::cout << "  byte aligned " << byteBytes / BENCH_TICKS << " bytes a tick, bit packed " << fullBytes / BENCH_TICKS
+              << " bytes a tick, bit packed delta " << deltaBytes / BENCH_TICKS << " bytes a tick (x"
+              << (double)byteBytes / deltaBytes << "), " << fullSnapshots << " sent in full"
+              << (mismatch ? ", DECODED STATE MISMATCH" : "") << std::endl;
+    std::cout << "  one packet: byte aligned " << byteBytes / BENCH_TICKS / MAX_CLIENTS << " bytes, bit packed "
+              << fullBytes / BENCH_TICKS / MAX_CLIENTS << " bytes, bit packed delta " << deltaBytes / BENCH_TICKS / MAX_CLIENTS
+              << " bytes" << std::endl;
+}
+
+class Timer {
+  private:
+    std::chrono::steady_clock::time_point _start = std::chrono::steady_clock::now();
+
+  public:
+    double ElapsedMs() const {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - _start).count();
+    }
+};
+
+/*
+ * Client state updates and server snapshots back and forth over loopback, the way the client and server
+ * loops handle them. `Buffer` is called for every datagram sent or received and returns something a
+ * NetBuffer can be taken from.
+ */
+template <typename Buffer>
+static void RoundTrips(Roar::NetServer &server, Roar::NetClient &client, UpdateStateMessage *update, GameStateMessage *game,
+                       Buffer &&buffer) {
+    sockaddr_in from;
+
+    for (int packet = 0; packet < BENCH_PACKETS; packet++) {
+        {
+            auto sent = buffer();
+            (*sent).WriteUInt8(MSG_UPDATE_STATE);
+            SerializeUpdateStateMessage(*sent, *update);
+            client.Send(*sent);
+        }
+        {
+            auto received = buffer();
+            while (server.Receive(*received, from) > 0) {
+                (*received).ReadUInt8();
+                update->ack_tick = DeserializeUpdateStateMessage(*received).ack_tick + 1;
+            }
+        }
+        {
+            auto sent = buffer();
+            (*sent).WriteUInt8(MSG_GAME_STATE);
+            SerializeGameStateDelta(*sent, packet, *game, NO_SNAPSHOT, nullptr);
+            server.SendTo(*sent, from);
+        }
+        {
+            auto received = buffer();
+            uint32_t tick;
+            uint32_t baseTick;
+            while (client.Receive(*received) > 0) {
+                (*received).ReadUInt8();
+                DeserializeSnapshotHeader(*received, tick, baseTick);
+                game->current_wave = DeserializeGameStateDelta(*received, nullptr).current_wave;
+            }
+        }
+    }
+}
+
+// Heap allocations per datagram with a NetBuffer made for every one, as the loops used to, and with pooled buffers.
+static void BenchBufferPool() {
+    Roar::NetServer server(BENCH_PORT);
+    Roar::NetClient client;
+    if (!server.Start() || !client.Connect("127.0.0.1", BENCH_PORT)) {
+        std::cout << "Buffer pool: cannot bind port " << BENCH_PORT << std::endl;
+        return;
+    }
+
+    auto update = std::make_unique<UpdateStateMessage>();
+    auto game = std::make_unique<GameStateMessage>();
+    *update = {};
+    *game = {};
+    update->missile_count = MAX_MISSILES_CLIENT;
+    game->client_count = MAX_CLIENTS;
+    for (unsigned int i = 0; i < MAX_CLIENTS; i++) {
+        game->client_states[i].client_id = i + 1;
+        SimulateClient(game->client_states[i], 0);
+    }
+
+    size_t before = allocations;
+    Timer fresh;
+    RoundTrips(server, client, update.get(), game.get(),
+               [] { return std::make_unique<Roar::NetBuffer>(Roar::MAX_DATAGRAM_SIZE); });
+    double freshMs = fresh.ElapsedMs();
+    size_t freshAllocations = allocations - before;
+
+    Roar::NetBufferPool pool;
+    before = allocations;
+    Timer pooled;
+    RoundTrips(server, client, update.get(), game.get(), [&] { return pool.Acquire(); });
+    double pooledMs = pooled.ElapsedMs();
+    size_t pooledAllocations = allocations - before;
+
+    // An update and a snapshot per round trip, each one sent then received
+    double datagrams = BENCH_PACKETS * 4.0;
+    std::cout << "Buffer pool, " << BENCH_PACKETS << " round trips over loopback" << std::endl;
+    std::cout << "  buffer per datagram " << freshMs << " ms, " << freshAllocations / datagrams
+              << " allocations a datagram, pooled " << pooledMs << " ms, " << pooledAllocations / datagrams
+              << " allocations a datagram (" << pooledAllocations << " in all)" << std::endl;
+}
+
+// Server side of a tick: every client's update in, a snapshot out to each of them
+struct ServerTick {
+    Roar::NetServer &server;
+    std::vector<sockaddr_in> addresses;
+    Roar::NetBuffer snapshot{Roar::MAX_DATAGRAM_SIZE};
+    std::unique_ptr<UpdateStateMessage> update = std::make_unique<UpdateStateMessage>();
+    size_t received = 0;
+
+    // One recvfrom per datagram and one sendto per client
+    void OneByOne(Roar::NetBuffer &buffer) {
+        sockaddr_in from;
+        while (server.Receive(buffer, from) > 0) {
+            buffer.ReadUInt8();
+            *update = DeserializeUpdateStateMessage(buffer);
+            received++;
+        }
+        for (const sockaddr_in &address : addresses)
+            server.SendTo(snapshot, address);
+    }
+
+    void Batched(std::vector<Roar::NetPacket> &incoming, std::vector<Roar::NetPacket> &outgoing) {
+        int count;
+        do {
+            count = server.ReceiveBatch(incoming);
+            for (int i = 0; i < count; i++) {
+                incoming[i].buffer->ReadUInt8();
+                *update = DeserializeUpdateStateMessage(*incoming[i].buffer);
+            }
+            received += std::max(count, 0);
+        } while (count == (int)incoming.size());
+        server.SendBatch(outgoing);
+    }
+};
+
+// Syscalls and packet rate of the server socket with BENCH_BATCH_CLIENTS clients sending a state update
+// every tick and getting a snapshot back, with and without recvmmsg/sendmmsg.
+static void BenchBatchedIo() {
+    Roar::NetServer server(BENCH_PORT);
+    std::vector<Roar::NetClient> clients(BENCH_BATCH_CLIENTS);
+    Roar::NetBuffer buffer(Roar::MAX_DATAGRAM_SIZE);
+    sockaddr_in from;
+    if (!server.Start()) {
+        std::cout << "Batched I/O: cannot bind port " << BENCH_PORT << std::endl;
+        return;
+    }
+
+    ServerTick tick{server};
+    tick.addresses.resize(clients.size());
+    for (size_t i = 0; i < clients.size(); i++) {
+        clients[i].Connect("127.0.0.1", BENCH_PORT);
+        buffer.Clear();
+        buffer.WriteUInt8((uint8_t)i);
+        clients[i].Send(buffer);
+    }
+    for (size_t i = 0; i < clients.size(); i++) {
+        buffer.Clear();
+        while (server.Receive(buffer, from) <= 0)
+            ;
+        tick.addresses[buffer.ReadUInt8()] = from;
+    }
+
+    // A 4 player game state, and the update of a client with a few missiles out
+    auto game = std::make_unique<GameStateMessage>();
+    *game = {};
+    game->client_count = MAX_CLIENTS;
+    for (int round = 0; round < 20; round++) {
+        for (unsigned int i = 0; i < MAX_CLIENTS; i++) {
+            game->client_states[i].client_id = i + 1;
+            SimulateClient(game->client_states[i], round);
+        }
+    }
+    tick.snapshot.WriteUInt8(MSG_GAME_STATE);
+    SerializeGameStateMessage(tick.snapshot, *game);
+
+    Roar::NetBuffer updateBuffer;
+    auto update = std::make_unique<UpdateStateMessage>();
+    *update = {};
+    update->missile_count = game->client_states[0].missile_count;
+    memcpy(update->missiles, game->client_states[0].missiles, update->missile_count * sizeof(Missile));
+    updateBuffer.WriteUInt8(MSG_UPDATE_STATE);
+    SerializeUpdateStateMessage(updateBuffer, *update);
+
+    Roar::NetBufferPool pool(4096, Roar::NetSocket::MAX_BATCH);
+    std::vector<Roar::NetBufferPool::Lease> leases;
+    std::vector<Roar::NetPacket> incoming;
+    std::vector<Roar::NetPacket> outgoing;
+    for (size_t i = 0; i < Roar::NetSocket::MAX_BATCH; i++) {
+        leases.push_back(pool.Acquire());
+        incoming.push_back(Roar::NetPacket{&*leases.back(), {}});
+    }
+    for (const sockaddr_in &address : tick.addresses)
+        outgoing.push_back(Roar::NetPacket{&tick.snapshot, address});
+
+    // Clients send and drain outside of the measured time
+    auto run = [&](bool batched, double &ms, size_t &syscalls) {
+        ms = 0.0;
+        syscalls = 0;
+        tick.received = 0;
+        for (int round = 0; round < BENCH_BATCH_TICKS; round++) {
+            for (Roar::NetClient &client : clients)
+                client.Send(updateBuffer);
+
+            size_t before = server.GetSyscallCount();
+            Timer timer;
+            if (batched)
+                tick.Batched(incoming, outgoing);
+            else
+                tick.OneByOne(buffer);
+            ms += timer.ElapsedMs();
+            syscalls += server.GetSyscallCount() - before;
+
+            for (Roar::NetClient &client : clients) {
+                while (client.Receive(buffer) > 0)
+                    ;
+            }
+        }
+    };
+
+    double loopMs;
+    double batchMs;
+    size_t loopSyscalls;
+    size_t batchSyscalls;
+    run(false, loopMs, loopSyscalls);
+    size_t loopReceived = tick.received;
+    run(true, batchMs, batchSyscalls);
+    size_t batchReceived = tick.received;
+
+    double packets = (double)BENCH_BATCH_TICKS * BENCH_BATCH_CLIENTS * 2;
+    std::cout << "Batched I/O, " << BENCH_BATCH_CLIENTS << " clients, " << BENCH_BATCH_TICKS << " ticks over loopback"
+              << std::endl;
+    std::cout << "  one by one " << (double)loopSyscalls / BENCH_BATCH_TICKS << " syscalls a tick, "
+              << packets / loopMs * 1000.0 << " packets/s (" << loopReceived << " received), batched "
+              << (double)batchSyscalls / BENCH_BATCH_TICKS << " syscalls a tick, " << packets / batchMs * 1000.0
+              << " packets/s (" << batchReceived << " received)" << std::endl;
+}
+
+// State of the tick loop benchmark, AppRun() takes plain function pointers
+static struct {
+    Roar::NetServer *server;
+    Roar::NetBuffer *buffer;
+    int ticks;
+    double waitedMs; // from a datagram being sent to the server handling it
+    size_t packets;
+} loop;
+
+static double NowMs() {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void HandleTimestamps() {
+    sockaddr_in from;
+    double sentMs;
+
+    while (loop.server->Receive(*loop.buffer, from) > 0) {
+        loop.buffer->ReadBytes(&sentMs, sizeof(sentMs));
+        loop.waitedMs += NowMs() - sentMs;
+        loop.packets++;
+    }
+}
+
+static void TickWork() {
+    HandleTimestamps();
+    Timer work;
+    while (work.ElapsedMs() < BENCH_TICK_WORK_MS)
+        ;
+    if (++loop.ticks == BENCH_LOOP_TICKS)
+        Roar::StopApp();
+}
+
+// The server loop as it was, a fixed sleep after each tick's work, against AppRun()'s deadlines woken up
+// by the socket, while a client sends a timestamped datagram every BENCH_PACKET_INTERVAL.
+static void BenchTickLoop() {
+    Roar::NetServer server(BENCH_PORT);
+    Roar::NetClient client;
+    Roar::NetBuffer buffer;
+    if (!server.Start() || !client.Connect("127.0.0.1", BENCH_PORT)) {
+        std::cout << "Tick loop: cannot bind port " << BENCH_PORT << std::endl;
+        return;
+    }
+    loop.server = &server;
+    loop.buffer = &buffer;
+
+    std::atomic<bool> sending{true};
+    std::thread sender([&] {
+        Roar::NetBuffer timestamp;
+        while (sending) {
+            double sentMs = NowMs();
+            timestamp.Clear();
+            timestamp.WriteBytes(&sentMs, sizeof(sentMs));
+            client.Send(timestamp);
+            std::this_thread::sleep_for(BENCH_PACKET_INTERVAL);
+        }
+    });
+
+    auto measure = [&](auto &&run, double &ticksPerSecond, double &waitedMs) {
+        loop.ticks = 0;
+        loop.waitedMs = 0.0;
+        loop.packets = 0;
+        Timer timer;
+        run();
+        ticksPerSecond = loop.ticks / timer.ElapsedMs() * 1000.0;
+        waitedMs = loop.waitedMs / loop.packets;
+    };
+
+    double sleepRate;
+    double sleepWaited;
+    measure(
+        [] {
+            while (loop.ticks < BENCH_LOOP_TICKS) {
+                TickWork();
+                std::this_thread::sleep_for(std::chrono::duration<double>(1.0 / TICK_RATE));
+            }
+        },
+        sleepRate, sleepWaited);
+
+    double deadlineRate;
+    double deadlineWaited;
+    measure(
+        [] {
+            Roar::AppRun(Roar::AppData{.headless = true,
+                                       .init = [] {},
+                                       .frame = TickWork,
+                                       .cleanup = [] {},
+                                       .tickRate = TICK_RATE,
+                                       .eventFd = [] { return loop.server->GetFd(); },
+                                       .event = HandleTimestamps,
+                                       .tickReportSeconds = 0.0});
+        },
+        deadlineRate, deadlineWaited);
+
+    sending = false;
+    sender.join();
+
+    const Roar::TickStats &stats = Roar::GetTickStats();
+    std::cout << "Tick loop, " << TICK_RATE << " Hz with " << BENCH_TICK_WORK_MS << " ms of work a tick, " << BENCH_LOOP_TICKS
+              << " ticks" << std::endl;
+    std::cout << "  sleep after work " << sleepRate << " ticks/s, datagrams waited " << sleepWaited << " ms, deadlines "
+              << deadlineRate << " ticks/s, datagrams waited " << deadlineWaited << " ms, ticks late by "
+              << stats.totalLateUs / stats.ticks << " us on average, " << stats.maxLateUs << " us at most" << std::endl;
+}
+
+int main() {
+    BenchSnapshots();
+    BenchBufferPool();
+    BenchBatchedIo();
+    BenchTickLoop();
+    return 0;
+}
@@ -2,68 +2,108 @@
 
 namespace Prefab {
 
-Entity MakeEnemy(Scene &_core, float posX, float posY) {
-    Entity e = _core.CreateEntity();
+static const char *PLAYER_SHEET = "resources/sprites/player_r-9c_war-head.png";
+static const char *ENEMY_SHEET = "resources/sprites/mob_bydo_minions.png";
+
+const Roar::TextureAtlas &SpriteAtlas() {
+    static Roar::TextureAtlas atlas({PLAYER_SHEET, ENEMY_SHEET});
+    return atlas;
+}
+
+// The page holding `sheet`, null if it failed to load
+static Roar::AtlasRegion SheetRegion(const char *sheet) {
+    const Roar::AtlasRegion *region = SpriteAtlas().Find(sheet);
+
+    return region ? *region : Roar::AtlasRegion{};
+}
+
+// Moves the frames of `anim`, written against its sprite sheet, to where the sheet sits in the atlas
+static AnimationComponent Remap(AnimationComponent anim, const Roar::AtlasRegion &region) {
+    anim.rect = Roar::TextureAtlas::Remap(region, anim.rect);
+    for (Rectangle &frame : anim._animationRectangle)
+        frame = Roar::TextureAtlas::Remap(region, frame);
+    return anim;
+}
+
+PrefabTemplate EnemyTemplate(Scene &_core) {
+    Roar::AtlasRegion region = SheetRegion(ENEMY_SHEET);
     EnemySprite sprite;
 
-    sprite.texture = LoadTexture("ressources/sprites/mob_bydo_minions.png");
-    _core.AddComponent(e, Position{Vector2{posX, posY}});
-    _core.AddComponent(e, Sprite{GREEN});
-    _core.AddComponent(e, Collider{
-                              Rectangle{posX, posY, 40, 40},
-                              false,
-                          });
-    _core.AddComponent(
-        e, AnimationComponent{
-               Rectangle{0, 0, 0, 0},
-               {Rectangle{0, 0, 0, 0}, Rectangle{0, 0, 0, 0}, Rectangle{0, 0, 0, 0}, Rectangle{0, 0, 0, 0}, Rectangle{0, 0, 0, 0}
-
-               },
-               0,
-               0,
-               8,
-           });
-    _core.AddComponent(e, Tag{false});
-    _core.AddComponent(e, sprite);
-    return e;
+    sprite.texture = region.page;
+    return _core.MakePrefab(Position{Vector2{0, 0}}, Sprite{GREEN, region.page, LAYER_ENEMIES},
+                            Collider{
+                                Rectangle{0, 0, 40, 40},
+                                false,
+                            },
+                            Remap(
+                                AnimationComponent{
+                                    Rectangle{0, 0, 0, 0},
+                                    {Rectangle{0, 0, 0, 0}, Rectangle{0, 0, 0, 0}, Rectangle{0, 0, 0, 0},
+                                     Rectangle{0, 0, 0, 0}, Rectangle{0, 0, 0, 0}},
+                                    0,
+                                    0,
+                                    8,
+                                },
+                                region),
+                            Tag{false}, sprite);
+}
+
+Entity MakeEnemy(Scene &_core, const PrefabTemplate &enemy, float posX, float posY) {
+    return _core.Instantiate(enemy, Position{Vector2{posX, posY}}, Collider{Rectangle{posX, posY, 40, 40}, false});
+}
+
+// Missile frames are cut from the player sheet
+static AnimationComponent MissileAnimation() {
+    return Remap(
+        AnimationComponent{
+            Rectangle{0, 0, 0, 0},
+            {Rectangle{0, 128, 25, 22}, Rectangle{25, 128, 31, 22}, Rectangle{56, 128, 40, 22}, Rectangle{96, 128, 55, 22},
+             Rectangle{151, 128, 72, 22}},
+            0,
+            0,
+            8,
+        },
+        SheetRegion(PLAYER_SHEET));
 }
 
+static Sprite MissileSprite() { return Sprite{RED, SheetRegion(PLAYER_SHEET).page, LAYER_MISSILES}; }
+
 Entity MakeMilssile(Scene &_core) {
     Entity e = _core.CreateEntity();
-    _core.AddComponent(e, AnimationComponent{
-                              Rectangle{0, 0, 0, 0},
-                              {Rectangle{0, 128, 25, 22}, Rectangle{25, 128, 31, 22}, Rectangle{56, 128, 40, 22},
-                               Rectangle{96, 128, 55, 22}, Rectangle{151, 128, 72, 22}},
-                              0,
-                              0,
-                              8,
-                          });
-    _core.AddComponent(e, Sprite{RED});
-    _core.AddComponent(e, Position{Vector2{0, 0}});
-    _core.AddComponent(e, Tag{false});
-    _core.AddComponent(e, MissileTag{});
+    _core.AddComponents(e, MissileAnimation(), MissileSprite(), Position{Vector2{0, 0}}, Tag{false}, MissileTag{});
     return e;
 }
 
-Entity MakePlayer(Scene &_core, float x, float y) {
-    Entity e = _core.CreateEntity();
+CommandBuffer::PendingEntity MakeMilssile(CommandBuffer &commands, Vector2 position) {
+    CommandBuffer::PendingEntity e = commands.CreateEntity();
+    AnimationComponent anim = MissileAnimation();
+
+    anim.rect = anim._animationRectangle[anim._current_frame];
+    commands.AddComponents(e, anim, MissileSprite(), Position{position}, Tag{false}, MissileTag{});
+    return e;
+}
+
+PrefabTemplate PlayerTemplate(Scene &_core) {
+    Roar::AtlasRegion region = SheetRegion(PLAYER_SHEET);
     PlayerSprite sprite;
-    sprite.texture = LoadTexture("resources/sprites/player_r-9c_war-head.png");
-    _core.AddComponent(e, Position{Vector2{x, y}});
-    _core.AddComponent(e, InputController{});
-    _core.AddComponent(e, sprite);
-    _core.AddComponent(e, AnimationComponent{
-                              Rectangle{0, 30, 32, 22},
-                          });
-    _core.AddComponent(e, Tag{true});
-    _core.AddComponent(e, Sprite{WHITE});
-    _core.AddComponent(e, playerCooldown{false});
-    _core.AddComponent(e, Collider{
-                              Rectangle{0, 30, 32, 22},
-                              true,
-                          });
-    _core.AddComponent(e, Velocity{0, 0});
-    _core.AddComponent(e, LocalPlayerTag{});
+
+    sprite.texture = region.page;
+    return _core.MakePrefab(Position{Vector2{0, 0}}, InputController{}, sprite,
+                            Remap(
+                                AnimationComponent{
+                                    Rectangle{0, 30, 32, 22},
+                                },
+                                region),
+                            Tag{true}, Sprite{WHITE, region.page, LAYER_PLAYERS}, playerCooldown{false},
+                            Collider{
+                                Rectangle{0, 30, 32, 22},
+                                true,
+                            },
+                            Velocity{0, 0}, LocalPlayerTag{});
+}
+
+Entity MakePlayer(Scene &_core, const PrefabTemplate &player, float x, float y) {
+    Entity e = _core.Instantiate(player, Position{Vector2{x, y}});
     // _core.AddComponent(e, CameraComponent{
     //     {0.0f, 0.0f},
     //     {0.0f, 0.0f},
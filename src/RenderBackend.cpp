@@ -0,0 +1,17 @@
+#include "IRenderBackend.h"
+
+namespace Roar {
+
+void RaylibRenderBackend::DrawSprites(TextureHandle texture, std::span<const DrawCommand> commands) {
+    const Texture2D &resolved = Assets().GetTexture(texture);
+
+    for (const DrawCommand &command : commands)
+        DrawTexturePro(resolved, command.source, command.dest, Vector2{0.0f, 0.0f}, 0.0f, command.tint);
+}
+
+void NullRenderBackend::DrawSprites(TextureHandle, std::span<const DrawCommand> commands) {
+    sprites += commands.size();
+    batches++;
+}
+
+} // namespace Roar
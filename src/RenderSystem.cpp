@@ -11,7 +11,7 @@ RenderSystem::~RenderSystem() {}
 void RenderSystem::Init() {}
 
 void RenderSystem::Update(Scene &scene) {
-    for (auto const &entity : mEntities) {
+    for (auto const &entity : Entities()) {
         auto &rectangle = scene.GetComponent<RectangleComponent>(entity);
         auto &transform = scene.GetComponent<TransformComponent>(entity);
 
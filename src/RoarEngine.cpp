@@ -1,5 +1,17 @@
 #include "RoarEngine.h"
 
+#include <chrono>
+#include <string>
+#include <thread>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <cstring>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#endif
+
 bool running = true;
 
 void CustomTraceLog(int msgType, const char *text, va_list args) {
@@ -45,14 +57,184 @@ namespace Roar {
 void StopApp() { running = false; }
 bool IsAppRunning() { return running; }
 
+using TickClock = std::chrono::steady_clock;
+
+// Ticks a schedule may fall behind before it starts over rather than run the missed ones back to back
+constexpr int MAX_LATE_TICKS = 5;
+
+static TickStats tickStats;
+
+static TickClock::duration Seconds(double seconds) {
+    return std::chrono::duration_cast<TickClock::duration>(std::chrono::duration<double>(seconds));
+}
+
+const TickStats &GetTickStats() { return tickStats; }
+
+static void RecordTick(double lateUs) {
+    int bucket = 0;
+    while (bucket < TickStats::BUCKETS - 1 && lateUs >= TickStats::BUCKET_LIMITS_US[bucket])
+        bucket++;
+
+    tickStats.histogram[bucket]++;
+    tickStats.ticks++;
+    tickStats.totalLateUs += lateUs;
+    if (lateUs > tickStats.maxLateUs)
+        tickStats.maxLateUs = lateUs;
+}
+
+static void ReportTicks() {
+    if (tickStats.ticks == 0)
+        return;
+
+    std::string histogram;
+    for (int i = 0; i < TickStats::BUCKETS; i++) {
+        histogram += i < TickStats::BUCKETS - 1 ? " <" + std::to_string((int)TickStats::BUCKET_LIMITS_US[i])
+                                                : " >=" + std::to_string((int)TickStats::BUCKET_LIMITS_US[i - 1]);
+        histogram += "us:" + std::to_string(tickStats.histogram[i]);
+    }
+    RO_LOG_INFO("Tick jitter over {} ticks:{}, mean {:.1f}us, max {:.1f}us, {} events, {} resyncs", tickStats.ticks, histogram,
+                tickStats.totalLateUs / tickStats.ticks, tickStats.maxLateUs, tickStats.events, tickStats.resyncs);
+}
+
+// Sleeps until a deadline of the tick schedule, waking up early when the watched fd turns readable
+class TickWaiter {
+#if defined(__linux__)
+  private:
+    int _epoll = -1;
+    int _timer = -1;
+    int _fd;
+    // Set once epoll or the timer failed, the waiter then sleeps until each deadline and ignores the fd
+    bool _sleeping = false;
+
+    void Fail(const char *call) {
+        RO_LOG_ERR("AppRun: {} failed ({}), ticks fall back to sleeping until each deadline", call, std::strerror(errno));
+        _sleeping = true;
+    }
+
+  public:
+    explicit TickWaiter(int fd) : _fd(fd) {
+        epoll_event event{};
+
+        _epoll = epoll_create1(EPOLL_CLOEXEC);
+        if (_epoll < 0) {
+            Fail("epoll_create1");
+            return;
+        }
+        _timer = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+        if (_timer < 0) {
+            Fail("timerfd_create");
+            return;
+        }
+        event.events = EPOLLIN;
+        event.data.fd = _timer;
+        if (epoll_ctl(_epoll, EPOLL_CTL_ADD, _timer, &event) < 0) {
+            Fail("epoll_ctl");
+            return;
+        }
+        event.data.fd = _fd;
+        if (_fd >= 0 && epoll_ctl(_epoll, EPOLL_CTL_ADD, _fd, &event) < 0)
+            Fail("epoll_ctl");
+    }
+
+    ~TickWaiter() {
+        if (_timer >= 0)
+            close(_timer);
+        if (_epoll >= 0)
+            close(_epoll);
+    }
+
+    // True when the fd woke it up. steady_clock is CLOCK_MONOTONIC, the deadline arms the timer as is.
+    bool Wait(TickClock::time_point deadline) {
+        auto since = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline.time_since_epoch()).count();
+        itimerspec spec{};
+        epoll_event events[2];
+
+        spec.it_value.tv_sec = since / 1000000000;
+        spec.it_value.tv_nsec = since % 1000000000;
+        if (!_sleeping && timerfd_settime(_timer, TFD_TIMER_ABSTIME, &spec, nullptr) < 0)
+            Fail("timerfd_settime");
+        if (_sleeping) {
+            std::this_thread::sleep_until(deadline);
+            return false;
+        }
+
+        bool readable = false;
+        int count = epoll_wait(_epoll, events, 2, -1);
+        if (count < 0 && errno != EINTR)
+            Fail("epoll_wait");
+        for (int i = 0; i < count; i++) {
+            if (events[i].data.fd == _fd) {
+                readable = true;
+            } else {
+                uint64_t expirations;
+                (void)!read(_timer, &expirations, sizeof(expirations));
+            }
+        }
+        return readable;
+    }
+#else
+  public:
+    explicit TickWaiter(SOCKET_TYPE) {}
+
+    bool Wait(TickClock::time_point deadline) {
+        std::this_thread::sleep_until(deadline);
+        return false;
+    }
+#endif
+};
+
+// frame() every 1/tickRate seconds. Deadlines are counted from the start, so the time a frame takes or a
+// late wakeup never pushes the following ticks back.
+static void RunTicks(const AppData &appdata) {
+    const TickClock::duration period = Seconds(1.0 / appdata.tickRate);
+    const SOCKET_TYPE fd = appdata.eventFd ? appdata.eventFd() : INVALID_SOCK;
+    RO_ASSERT((fd == INVALID_SOCK || appdata.event) && "AppRun: an eventFd needs an event callback");
+
+    TickWaiter waiter(fd);
+    TickClock::time_point deadline = TickClock::now();
+    TickClock::time_point report = deadline + Seconds(appdata.tickReportSeconds);
+
+    while (IsAppRunning()) {
+        TickClock::time_point now = TickClock::now();
+
+        if (now < deadline) {
+            if (waiter.Wait(deadline)) {
+                tickStats.events++;
+                appdata.event();
+            }
+            continue;
+        }
+
+        RecordTick(std::chrono::duration<double, std::micro>(now - deadline).count());
+        appdata.frame();
+        deadline += period;
+
+        now = TickClock::now();
+        if (now - deadline > period * MAX_LATE_TICKS) {
+            deadline = now + period;
+            tickStats.resyncs++;
+        }
+        if (appdata.tickReportSeconds > 0.0 && now >= report) {
+            ReportTicks();
+            report += Seconds(appdata.tickReportSeconds);
+        }
+    }
+    ReportTicks();
+}
+
 void AppRun(AppData appdata) {
     SetTraceLogCallback(CustomTraceLog);
+    running = true;
+    tickStats = TickStats{};
 
     if (!appdata.headless)
         InitWindow(appdata.width, appdata.height, appdata.name == nullptr ? "Name" : appdata.name);
 
     appdata.init();
 
+    if (appdata.headless && appdata.tickRate > 0)
+        RunTicks(appdata);
+
     while (IsAppRunning()) {
         if (appdata.headless) {
             appdata.frame();
@@ -60,6 +242,7 @@ void AppRun(AppData appdata) {
             if (WindowShouldClose()) {
                 StopApp();
             }
+            Assets().Update(appdata.assetUploadMs);
             ClearBackground(RAYWHITE);
             BeginDrawing();
             appdata.frame();
@@ -67,8 +250,10 @@ void AppRun(AppData appdata) {
         }
     }
 
-    if (!appdata.headless)
+    if (!appdata.headless) {
+        Assets().Clear();
         CloseWindow();
+    }
 }
 
 }; // namespace Roar
@@ -0,0 +1,120 @@
+#include "Scene.h"
+#include <algorithm>
+#include <iostream>
+
+void Scene::Init(StorageBackend backend) {
+    _entityManager = std::make_unique<EntityManager>();
+    _componentManager = std::make_unique<ComponentManager>();
+    _systemManager = std::make_unique<SystemManager>();
+    _archetypes.reset();
+    if (backend == StorageBackend::Archetype)
+        _archetypes = std::make_unique<ArchetypeStorage>();
+
+    _commandBuffers.clear();
+    for (uint32_t i = 0; i <= Roar::Jobs().WorkerCount(); i++)
+        _commandBuffers.push_back(std::make_unique<CommandBuffer>());
+}
+
+void Scene::Clear() {
+    for (auto &commands : _commandBuffers)
+        commands = std::make_unique<CommandBuffer>();
+    if (_archetypes)
+        _archetypes->Clear();
+    _componentManager->Clear();
+    _systemManager->Clear();
+    _entityManager->Clear();
+    for (auto &removed : _removed)
+        removed.clear();
+}
+
+Signature Scene::ReleaseEntity(Entity entity) {
+    Signature committed = _entityManager->GetCommittedSignature(entity);
+    Signature signature = _entityManager->GetSignature(entity);
+
+    for (ComponentType type = 0; type < MAX_COMPONENTS; type++) {
+        if (signature.test(type))
+            RecordRemoval(entity, type);
+    }
+    _entityManager->DestroyEntity(entity);
+    if (_archetypes)
+        _archetypes->EntityDestroyed(entity);
+    else
+        _componentManager->EntityDestroyed(entity, signature);
+    return committed;
+}
+
+void Scene::DestroyEntity(Entity entity) { _systemManager->EntityDestroyed(entity, ReleaseEntity(entity)); }
+
+void Scene::CreateEntitiesFrom(std::span<Entity> entities, Signature signature,
+                               const std::array<const void *, MAX_COMPONENTS> &components) {
+    _entityManager->Reserve(entities.size());
+    for (Entity &entity : entities) {
+        entity = _entityManager->CreateEntity();
+        _entityManager->SetSignature(entity, signature);
+        _entityManager->SetCommittedSignature(entity, signature);
+    }
+
+    if (_archetypes) {
+        _archetypes->Insert(entities, signature, components);
+    } else {
+        for (ComponentType type = 0; type < MAX_COMPONENTS; type++) {
+            if (signature.test(type))
+                _componentManager->AddComponent(type, entities, components[type]);
+        }
+    }
+    _systemManager->EntitiesSignatureChanged(entities, Signature{}, signature);
+}
+
+void Scene::DestroyEntities(std::span<const Entity> entities) {
+    std::vector<std::pair<unsigned long, Entity>> released;
+
+    released.reserve(entities.size());
+    for (Entity entity : entities)
+        released.emplace_back(ReleaseEntity(entity).to_ulong(), entity);
+
+    // Entities that shared a committed signature leave their systems together
+    std::sort(released.begin(), released.end());
+    std::vector<Entity> batch;
+    for (size_t begin = 0; begin < released.size();) {
+        size_t end = begin;
+
+        batch.clear();
+        while (end < released.size() && released[end].first == released[begin].first)
+            batch.push_back(released[end++].second);
+        _systemManager->EntitiesSignatureChanged(batch, Signature(released[begin].first), Signature{});
+        begin = end;
+    }
+}
+
+void Scene::printSignature(Entity entity) {
+    Signature sig = _entityManager->GetSignature(entity);
+
+    std::cout << "Signature => " << sig << std::endl;
+}
+
+void Scene::CommitSignature(Entity entity) {
+    Signature committed = _entityManager->GetCommittedSignature(entity);
+    Signature signature = _entityManager->GetSignature(entity);
+
+    if (committed == signature)
+        return;
+    _entityManager->SetCommittedSignature(entity, signature);
+    _systemManager->EntitySignatureChanged(entity, committed, signature);
+}
+
+void Scene::UpdateAllSystem() {
+    _systemManager->SystemUpdateOrder();
+    FlushCommands();
+
+    // Every system has run since these removals
+    Tick oldest = _systemManager->OldestRun();
+    for (auto &removed : _removed) {
+        removed.erase(std::remove_if(removed.begin(), removed.end(), [&](const Removal &removal) { return removal.tick <= oldest; }),
+                      removed.end());
+    }
+}
+
+void Scene::FlushCommands() {
+    for (auto &commands : _commandBuffers)
+        commands->Playback(*this);
+}
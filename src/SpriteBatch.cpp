@@ -0,0 +1,76 @@
+#include "SpriteBatch.h"
+
+#include <algorithm>
+
+namespace Roar {
+
+void SpriteBatch::Sort() {
+    // A frame holds a handful of layer and texture pairs: count each one, then scatter the
+    // commands to their slot. Linear in the command count and stable, like the queuing order.
+    _runs.clear();
+    size_t last = 0;
+    for (const DrawCommand &command : _commands) {
+        if (last < _runs.size() && _runs[last].key == command.key) {
+            _runs[last].count++;
+            continue;
+        }
+        last = 0;
+        while (last < _runs.size() && _runs[last].key != command.key)
+            last++;
+        if (last == _runs.size()) {
+            if (_runs.size() == MAX_COUNTED_KEYS) {
+                std::stable_sort(_commands.begin(), _commands.end(),
+                                 [](const DrawCommand &a, const DrawCommand &b) { return a.key < b.key; });
+                return;
+            }
+            _runs.push_back(Run{command.key, 0});
+        }
+        _runs[last].count++;
+    }
+    if (_runs.size() < 2)
+        return;
+
+    std::sort(_runs.begin(), _runs.end(), [](const Run &a, const Run &b) { return a.key < b.key; });
+    size_t offset = 0;
+    for (Run &run : _runs) {
+        size_t count = run.count;
+        run.count = offset;
+        offset += count;
+    }
+    _sorted.resize(_commands.size());
+    for (const DrawCommand &command : _commands) {
+        if (_runs[last].key != command.key) {
+            last = 0;
+            while (_runs[last].key != command.key)
+                last++;
+        }
+        _sorted[_runs[last].count++] = command;
+    }
+    _commands.swap(_sorted);
+}
+
+void SpriteBatch::Flush(IRenderBackend &backend) {
+    Sort();
+
+    _stats = SpriteBatchStats{_commands.size(), 0};
+    size_t begin = 0;
+    while (begin < _commands.size()) {
+        TextureHandle texture = _commands[begin].Texture();
+        size_t end = begin + 1;
+
+        // A run crosses layers as long as the texture stays the same
+        while (end < _commands.size() && _commands[end].Texture() == texture)
+            end++;
+        backend.DrawSprites(texture, std::span<const DrawCommand>(_commands.data() + begin, end - begin));
+        _stats.batches++;
+        begin = end;
+    }
+    _commands.clear();
+}
+
+void SpriteBatch::Flush() {
+    RaylibRenderBackend raylib;
+    Flush(raylib);
+}
+
+} // namespace Roar
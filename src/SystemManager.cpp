@@ -0,0 +1,146 @@
+#include "SystemManager.h"
+#include "JobSystem.h"
+
+bool SystemManager::Exclusive(const SystemEntry &entry) {
+    return entry.system->structural || (entry.reads.none() && entry.writes.none());
+}
+
+bool SystemManager::Conflicts(const SystemEntry &a, const SystemEntry &b) {
+    if (Exclusive(a) || Exclusive(b))
+        return true;
+    return (a.writes & (b.reads | b.writes)).any() || (b.writes & a.reads).any();
+}
+
+bool SystemManager::ScheduleOutdated() const {
+    if (_scheduleDirty || _schedule.size() != _systems.size())
+        return true;
+    for (auto &node : _schedule) {
+        if (node.order != _systems[node.system].system->order)
+            return true;
+    }
+    return false;
+}
+
+void SystemManager::BuildSchedule() {
+    std::vector<size_t> sorted(_systems.size());
+
+    for (size_t i = 0; i < sorted.size(); i++)
+        sorted[i] = i;
+    std::stable_sort(sorted.begin(), sorted.end(),
+                     [this](size_t a, size_t b) { return _systems[a].system->order < _systems[b].system->order; });
+
+    _schedule.clear();
+    for (size_t i = 0; i < sorted.size(); i++) {
+        _schedule.push_back(ScheduleNode{sorted[i], _systems[sorted[i]].system->order});
+        for (size_t j = 0; j < i; j++) {
+            if (!Conflicts(_systems[sorted[j]], _systems[sorted[i]]))
+                continue;
+            _schedule[j].dependents.push_back(i);
+            _schedule[i].dependencies++;
+        }
+    }
+    _remaining = std::make_unique<std::atomic<uint32_t>[]>(_schedule.size());
+    _timeline.assign(_schedule.size(), SystemTiming{});
+    _scheduleDirty = false;
+}
+
+void SystemManager::Dispatch(size_t node) {
+    Roar::JobSystem &jobs = Roar::Jobs();
+
+    if (_systems[_schedule[node].system].system->mainThread || jobs.WorkerCount() == 0) {
+        std::lock_guard<std::mutex> lock(_runMutex);
+        _mainQueue.push_back(node);
+        _runCondition.notify_all();
+        return;
+    }
+    jobs.Submit([this, node] { Execute(node); });
+}
+
+void SystemManager::Execute(size_t node) {
+    using Ms = std::chrono::duration<double, std::milli>;
+    SystemEntry &entry = _systems[_schedule[node].system];
+    SystemTiming &timing = _timeline[node];
+    ChangeTicks::SystemRun outer;
+
+    timing.name = entry.name;
+    timing.worker = Roar::JobSystem::CurrentWorker();
+    timing.startMs = Ms(std::chrono::steady_clock::now() - _frameStart).count();
+    entry.lastRun = ChangeTicks::BeginSystem(entry.lastRun, outer);
+    entry.system->Update();
+    ChangeTicks::EndSystem(outer);
+    timing.endMs = Ms(std::chrono::steady_clock::now() - _frameStart).count();
+
+    for (size_t dependent : _schedule[node].dependents) {
+        if (_remaining[dependent].fetch_sub(1, std::memory_order_acq_rel) == 1)
+            Dispatch(dependent);
+    }
+
+    std::lock_guard<std::mutex> lock(_runMutex);
+    _completed++;
+    _runCondition.notify_all();
+}
+
+void SystemManager::EntitiesSignatureChanged(std::span<const Entity> entities, Signature oldSignature, Signature newSignature) {
+    Signature changed = oldSignature ^ newSignature;
+
+    if (changed.none() || entities.empty())
+        return;
+    _visitStamp++;
+
+    for (ComponentType type = 0; type < MAX_COMPONENTS; type++) {
+        if (!changed.test(type))
+            continue;
+        for (size_t index : _systemsByComponent[type])
+            UpdateMembership(index, entities, oldSignature, newSignature);
+    }
+
+    // Gaining a first component or losing the last one changes unfiltered membership
+    if (oldSignature.none() || newSignature.none()) {
+        for (size_t index : _unfilteredSystems)
+            UpdateMembership(index, entities, oldSignature, newSignature);
+    }
+}
+
+void SystemManager::SystemUpdateOrder() {
+    if (ScheduleOutdated())
+        BuildSchedule();
+    if (_schedule.empty())
+        return;
+
+    _frameStart = std::chrono::steady_clock::now();
+    _completed = 0;
+    for (size_t node = 0; node < _schedule.size(); node++)
+        _remaining[node].store(_schedule[node].dependencies, std::memory_order_relaxed);
+    for (size_t node = 0; node < _schedule.size(); node++) {
+        if (_schedule[node].dependencies == 0)
+            Dispatch(node);
+    }
+
+    std::unique_lock<std::mutex> lock(_runMutex);
+    while (_completed < _schedule.size()) {
+        if (_mainQueue.empty()) {
+            _runCondition.wait(lock);
+            continue;
+        }
+        size_t node = _mainQueue.front();
+        _mainQueue.pop_front();
+        lock.unlock();
+        Execute(node);
+        lock.lock();
+    }
+}
+
+Tick SystemManager::OldestRun() const {
+    Tick oldest = ChangeTicks::Now();
+
+    for (auto &entry : _systems)
+        oldest = std::min(oldest, entry.lastRun);
+    return oldest;
+}
+
+void SystemManager::Clear() {
+    for (auto &entry : _systems) {
+        entry.system->_matched.clear();
+        entry.system->OnClear();
+    }
+}
@@ -0,0 +1,118 @@
+#include "TextureAtlas.h"
+
+#include <algorithm>
+#include <numeric>
+#include <spdlog/spdlog.h>
+
+namespace Roar {
+
+TextureAtlas::~TextureAtlas() {
+    for (TextureHandle page : _pages)
+        Assets().Release(page);
+}
+
+void TextureAtlas::Build(const std::vector<std::string> &paths, int pageSize, int padding) {
+    // Distinguishes the pages of every atlas in the asset cache
+    static uint32_t atlasCount = 0;
+    std::vector<Image> images;
+    std::vector<std::string> packed;
+    std::vector<Vector2> sizes;
+
+    for (const std::string &path : paths) {
+        Image image = LoadImage(path.c_str());
+
+        if (image.data == nullptr) {
+            spdlog::warn("Failed to load atlas image {}", path);
+            continue;
+        }
+        images.push_back(image);
+        packed.push_back(path);
+        sizes.push_back(Vector2{static_cast<float>(image.width), static_cast<float>(image.height)});
+    }
+
+    std::vector<Placement> placements = Pack(sizes, pageSize, padding);
+    int pageCount = 0;
+    for (const Placement &placement : placements)
+        pageCount = std::max(pageCount, placement.page + 1);
+
+    uint32_t atlas = atlasCount++;
+    for (int page = 0; page < pageCount; page++) {
+        // Pages are only as tall as their content
+        int height = 0;
+        for (size_t i = 0; i < images.size(); i++) {
+            if (placements[i].page == page)
+                height = std::max(height, placements[i].y + images[i].height);
+        }
+
+        Image pageImage = GenImageColor(pageSize, height, BLANK);
+        for (size_t i = 0; i < images.size(); i++) {
+            if (placements[i].page != page)
+                continue;
+            Rectangle source{0, 0, sizes[i].x, sizes[i].y};
+            Rectangle dest{static_cast<float>(placements[i].x), static_cast<float>(placements[i].y), sizes[i].x, sizes[i].y};
+            ImageDraw(&pageImage, images[i], source, dest, WHITE);
+        }
+
+        TextureHandle handle =
+            Assets().AcquireTexture("atlas/" + std::to_string(atlas) + "/" + std::to_string(page), pageImage);
+        UnloadImage(pageImage);
+        _pages.push_back(handle);
+    }
+
+    for (size_t i = 0; i < images.size(); i++) {
+        const Placement &placement = placements[i];
+
+        if (placement.page < 0) {
+            spdlog::warn("Atlas image {} ({}x{}) is larger than a {} page", packed[i], images[i].width, images[i].height,
+                         pageSize);
+        } else {
+            Rectangle rect{static_cast<float>(placement.x), static_cast<float>(placement.y), sizes[i].x, sizes[i].y};
+            _regions[packed[i]] = AtlasRegion{_pages[placement.page], rect};
+        }
+        UnloadImage(images[i]);
+    }
+}
+
+const AtlasRegion *TextureAtlas::Find(const std::string &path) const {
+    auto region = _regions.find(path);
+
+    return region != _regions.end() ? &region->second : nullptr;
+}
+
+std::vector<TextureAtlas::Placement> TextureAtlas::Pack(const std::vector<Vector2> &sizes, int pageSize, int padding) {
+    std::vector<Placement> placements(sizes.size(), Placement{-1, 0, 0});
+    std::vector<size_t> order(sizes.size());
+
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return sizes[a].y > sizes[b].y; });
+
+    int page = -1;
+    int shelfY = 0;
+    int shelfHeight = 0;
+    int x = 0;
+    for (size_t i : order) {
+        int width = static_cast<int>(sizes[i].x);
+        int height = static_cast<int>(sizes[i].y);
+
+        if (width > pageSize || height > pageSize)
+            continue;
+        if (page >= 0 && x + width > pageSize) {
+            // Next shelf
+            shelfY += shelfHeight + padding;
+            shelfHeight = 0;
+            x = 0;
+        }
+        if (page < 0 || shelfY + height > pageSize) {
+            page++;
+            shelfY = 0;
+            shelfHeight = 0;
+            x = 0;
+        }
+        placements[i] = Placement{page, x, shelfY};
+        shelfHeight = std::max(shelfHeight, height);
+        x += width + padding;
+    }
+    return placements;
+}
+
+} // namespace Roar
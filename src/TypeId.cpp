@@ -0,0 +1,32 @@
+#include "TypeId.h"
+#include <mutex>
+#include <unordered_map>
+
+namespace TypeInfo {
+
+namespace {
+std::mutex &RegistryMutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+
+std::unordered_map<std::uint64_t, TypeId> &Registry() {
+    static std::unordered_map<std::uint64_t, TypeId> registry;
+    return registry;
+}
+} // namespace
+
+TypeId Register(std::uint64_t hash) {
+    std::lock_guard<std::mutex> lock(RegistryMutex());
+    auto &registry = Registry();
+
+    return registry.try_emplace(hash, static_cast<TypeId>(registry.size())).first->second;
+}
+
+TypeId Count() {
+    std::lock_guard<std::mutex> lock(RegistryMutex());
+
+    return static_cast<TypeId>(Registry().size());
+}
+
+} // namespace TypeInfo
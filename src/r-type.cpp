@@ -1,136 +1,282 @@
 #include "r-type.h"
+#include "BitStream.h"
 
+#include <algorithm>
+#include <cstddef>
 #include <cstring>
 #include <limits.h>
 #include <stdlib.h>
 
+const Rectangle MISSILE_FRAMES[MISSILE_FRAME_COUNT] = {
+    {0, 128, 25, 22}, {25, 128, 31, 22}, {56, 128, 40, 22}, {96, 128, 55, 22}, {151, 128, 72, 22}};
+
+// Wire schemas, what each struct sends and how many bits it takes
+
+static const Roar::FieldSchema MISSILE_SCHEMA[] = {
+    Roar::QuantizedField(offsetof(Missile, pos.x), MIN_FLOAT_VAL, MAX_FLOAT_VAL, POSITION_BITS),
+    Roar::QuantizedField(offsetof(Missile, pos.y), MIN_FLOAT_VAL, MAX_FLOAT_VAL, POSITION_BITS),
+    Roar::BitsField(offsetof(Missile, currentFrame), std::bit_width((unsigned int)MISSILE_FRAME_COUNT - 1))};
+
+// client_id and the missiles are written apart, the id identifies the client in deltas
+static const Roar::FieldSchema CLIENT_SCHEMA[] = {Roar::RangedIntField(offsetof(ClientState, x), 0, GAME_WIDTH),
+                                                  Roar::RangedIntField(offsetof(ClientState, y), 0, GAME_HEIGHT)};
+
+static const Roar::FieldSchema UPDATE_STATE_SCHEMA[] = {Roar::RangedIntField(offsetof(UpdateStateMessage, x), 0, GAME_WIDTH),
+                                                        Roar::RangedIntField(offsetof(UpdateStateMessage, y), 0, GAME_HEIGHT),
+                                                        Roar::VarUIntField(offsetof(UpdateStateMessage, ack_tick))};
+
+static const Roar::FieldSchema MOB_SCHEMA[] = {
+    Roar::VarUIntField(offsetof(MobState, mob_id)),
+    Roar::QuantizedField(offsetof(MobState, x), MIN_FLOAT_VAL, MAX_FLOAT_VAL, POSITION_BITS),
+    Roar::QuantizedField(offsetof(MobState, y), MIN_FLOAT_VAL, MAX_FLOAT_VAL, POSITION_BITS),
+    Roar::BoolField(offsetof(MobState, active))};
+
+// Wave system info
+static const Roar::FieldSchema WAVE_SCHEMA[] = {Roar::FloatField(offsetof(GameStateMessage, countdown_timer)),
+                                                Roar::VarUIntField(offsetof(GameStateMessage, current_wave)),
+                                                Roar::BoolField(offsetof(GameStateMessage, wave_active))};
+
+// Baseline of whatever the base snapshot does not have
+static const GameStateMessage EMPTY_GAME_STATE = {};
+static const ClientState &EMPTY_CLIENT = EMPTY_GAME_STATE.client_states[0];
 
 // Serialization functions using NetBuffer
 
-void SerializeMissile(Roar::INetBuffer &buffer, const Missile &missile) {
-    buffer.WriteFloat(missile.pos.x);
-    buffer.WriteFloat(missile.pos.y);
-    buffer.WriteFloat(missile.rect.x);
-    buffer.WriteFloat(missile.rect.y);
-    buffer.WriteFloat(missile.rect.width);
-    buffer.WriteFloat(missile.rect.height);
-    buffer.WriteUInt32(missile.currentFrame);
-    buffer.WriteUInt32(missile.framesSpeed);
-    buffer.WriteUInt32(missile.framesCounter);
+static void WriteMissile(Roar::BitWriter &writer, const Missile &missile) { Roar::WriteFields(writer, MISSILE_SCHEMA, &missile); }
+
+// The frame rectangle is the only part of the animation drawn for a remote missile
+static void CompleteMissile(Missile &missile) {
+    missile.currentFrame %= MISSILE_FRAME_COUNT;
+    missile.rect = MISSILE_FRAMES[missile.currentFrame];
 }
 
-Missile DeserializeMissile(Roar::INetBuffer &buffer) {
-    Missile missile;
-    missile.pos.x = buffer.ReadFloat();
-    missile.pos.y = buffer.ReadFloat();
-    missile.rect.x = buffer.ReadFloat();
-    missile.rect.y = buffer.ReadFloat();
-    missile.rect.width = buffer.ReadFloat();
-    missile.rect.height = buffer.ReadFloat();
-    missile.currentFrame = buffer.ReadUInt32();
-    missile.framesSpeed = buffer.ReadUInt32();
-    missile.framesCounter = buffer.ReadUInt32();
+static Missile ReadMissile(Roar::BitReader &reader) {
+    Missile missile = EMPTY_CLIENT.missiles[0];
+    Roar::ReadFields(reader, MISSILE_SCHEMA, &missile);
+    CompleteMissile(missile);
     return missile;
 }
 
-void SerializeUpdateStateMessage(Roar::INetBuffer &buffer, const UpdateStateMessage &msg) {
-    buffer.WriteInt32(msg.x);
-    buffer.WriteInt32(msg.y);
-    buffer.WriteUInt32(msg.missile_count);
-
-    for (unsigned int i = 0; i < msg.missile_count; i++) {
-        SerializeMissile(buffer, msg.missiles[i]);
-    }
+static void WriteMissiles(Roar::BitWriter &writer, const Missile *missiles, unsigned int count) {
+    count = std::min(count, (unsigned int)MAX_MISSILES_CLIENT);
+    writer.WriteVarUInt(count);
+    for (unsigned int i = 0; i < count; i++)
+        WriteMissile(writer, missiles[i]);
 }
 
-UpdateStateMessage DeserializeUpdateStateMessage(Roar::INetBuffer &buffer) {
-    UpdateStateMessage msg;
-    msg.x = buffer.ReadInt32();
-    msg.y = buffer.ReadInt32();
-    msg.missile_count = buffer.ReadUInt32();
-
-    if (msg.missile_count > MAX_MISSILES_CLIENT)
-        msg.missile_count = MAX_MISSILES_CLIENT;
+static unsigned int ReadMissiles(Roar::BitReader &reader, Missile *missiles) {
+    unsigned int count = std::min(reader.ReadVarUInt(), (uint32_t)MAX_MISSILES_CLIENT);
+    for (unsigned int i = 0; i < count; i++)
+        missiles[i] = ReadMissile(reader);
+    return count;
+}
 
-    for (unsigned int i = 0; i < msg.missile_count; i++) {
-        msg.missiles[i] = DeserializeMissile(buffer);
-    }
+static void WriteClientState(Roar::BitWriter &writer, const ClientState &state) {
+    writer.WriteVarUInt(state.client_id);
+    Roar::WriteFields(writer, CLIENT_SCHEMA, &state);
+    WriteMissiles(writer, state.missiles, state.missile_count);
+}
 
-    return msg;
+static ClientState ReadClientState(Roar::BitReader &reader) {
+    ClientState state = EMPTY_CLIENT;
+    state.client_id = reader.ReadVarUInt();
+    Roar::ReadFields(reader, CLIENT_SCHEMA, &state);
+    state.missile_count = ReadMissiles(reader, state.missiles);
+    return state;
 }
 
-void SerializeClientState(Roar::INetBuffer & buffer, const ClientState &state) {
-    buffer.WriteUInt32(state.client_id);
-    buffer.WriteInt32(state.x);
-    buffer.WriteInt32(state.y);
-    buffer.WriteUInt32(state.missile_count);
+void SerializeMissile(Roar::INetBuffer &buffer, const Missile &missile) {
+    Roar::BitWriter writer(buffer);
+    WriteMissile(writer, missile);
+    writer.Flush();
+}
 
-    for (unsigned int i = 0; i < state.missile_count; i++) {
-        SerializeMissile(buffer, state.missiles[i]);
-    }
+Missile DeserializeMissile(Roar::INetBuffer &buffer) {
+    Roar::BitReader reader(buffer);
+    return ReadMissile(reader);
 }
 
-ClientState DeserializeClientState(Roar::INetBuffer &buffer) {
-    ClientState state;
-    state.client_id = buffer.ReadUInt32();
-    state.x = buffer.ReadInt32();
-    state.y = buffer.ReadInt32();
-    state.missile_count = buffer.ReadUInt32();
+void SerializeUpdateStateMessage(Roar::INetBuffer &buffer, const UpdateStateMessage &msg) {
+    Roar::BitWriter writer(buffer);
+    Roar::WriteFields(writer, UPDATE_STATE_SCHEMA, &msg);
+    WriteMissiles(writer, msg.missiles, msg.missile_count);
+    writer.Flush();
+}
 
-    if (state.missile_count > MAX_MISSILES_CLIENT)
-        state.missile_count = MAX_MISSILES_CLIENT;
+UpdateStateMessage DeserializeUpdateStateMessage(Roar::INetBuffer &buffer) {
+    Roar::BitReader reader(buffer);
+    UpdateStateMessage msg;
+    Roar::ReadFields(reader, UPDATE_STATE_SCHEMA, &msg);
+    msg.missile_count = ReadMissiles(reader, msg.missiles);
+    return msg;
+}
 
-    for (unsigned int i = 0; i < state.missile_count; i++) {
-        state.missiles[i] = DeserializeMissile(buffer);
-    }
+void SerializeClientState(Roar::INetBuffer &buffer, const ClientState &state) {
+    Roar::BitWriter writer(buffer);
+    WriteClientState(writer, state);
+    writer.Flush();
+}
 
-    return state;
+ClientState DeserializeClientState(Roar::INetBuffer &buffer) {
+    Roar::BitReader reader(buffer);
+    return ReadClientState(reader);
 }
 
 void SerializeMobState(Roar::INetBuffer &buffer, const MobState &mob) {
-    buffer.WriteUInt32(mob.mob_id);
-    buffer.WriteFloat(mob.x);
-    buffer.WriteFloat(mob.y);
-    buffer.WriteUInt8(mob.active ? 1 : 0);
+    Roar::BitWriter writer(buffer);
+    Roar::WriteFields(writer, MOB_SCHEMA, &mob);
+    writer.Flush();
 }
 
 MobState DeserializeMobState(Roar::INetBuffer &buffer) {
+    Roar::BitReader reader(buffer);
     MobState mob;
-    mob.mob_id = buffer.ReadUInt32();
-    mob.x = buffer.ReadFloat();
-    mob.y = buffer.ReadFloat();
-    mob.active = buffer.ReadUInt8() != 0;
+    Roar::ReadFields(reader, MOB_SCHEMA, &mob);
     return mob;
 }
 
 void SerializeGameStateMessage(Roar::INetBuffer &buffer, const GameStateMessage &msg) {
-    buffer.WriteUInt32(msg.client_count);
+    Roar::BitWriter writer(buffer);
+    unsigned int client_count = std::min(msg.client_count, (unsigned int)MAX_CLIENTS);
 
-    for (unsigned int i = 0; i < msg.client_count; i++) {
-        SerializeClientState(buffer, msg.client_states[i]);
-    }
+    writer.WriteVarUInt(client_count);
+    for (unsigned int i = 0; i < client_count; i++)
+        WriteClientState(writer, msg.client_states[i]);
 
-    // Wave system info
-    buffer.WriteFloat(msg.countdown_timer);
-    buffer.WriteUInt32(msg.current_wave);
-    buffer.WriteUInt8(msg.wave_active ? 1 : 0);
+    Roar::WriteFields(writer, WAVE_SCHEMA, &msg);
+    writer.Flush();
 }
 
 GameStateMessage DeserializeGameStateMessage(Roar::INetBuffer &buffer) {
-    GameStateMessage msg;
-    msg.client_count = buffer.ReadUInt32();
+    Roar::BitReader reader(buffer);
+    GameStateMessage msg = {};
+
+    msg.client_count = std::min(reader.ReadVarUInt(), (uint32_t)MAX_CLIENTS);
+    for (unsigned int i = 0; i < msg.client_count; i++)
+        msg.client_states[i] = ReadClientState(reader);
+
+    Roar::ReadFields(reader, WAVE_SCHEMA, &msg);
+    return msg;
+}
+
+// Snapshots
+
+void ClearSnapshots(SnapshotHistory &history) {
+    for (unsigned int i = 0; i < SNAPSHOT_HISTORY; i++)
+        history.ticks[i] = NO_SNAPSHOT;
+}
+
+void StoreSnapshot(SnapshotHistory &history, uint32_t tick, const GameStateMessage &state) {
+    history.ticks[tick % SNAPSHOT_HISTORY] = tick;
+    history.states[tick % SNAPSHOT_HISTORY] = state;
+}
+
+const GameStateMessage *FindSnapshot(const SnapshotHistory &history, uint32_t tick) {
+    if (tick == NO_SNAPSHOT || history.ticks[tick % SNAPSHOT_HISTORY] != tick)
+        return nullptr;
+    return &history.states[tick % SNAPSHOT_HISTORY];
+}
+
+static const ClientState &BaseClient(const GameStateMessage *base, uint32_t client_id) {
+    if (base) {
+        for (unsigned int i = 0; i < base->client_count; i++) {
+            if (base->client_states[i].client_id == client_id)
+                return base->client_states[i];
+        }
+    }
+    return EMPTY_CLIENT;
+}
+
+static const Missile &BaseMissile(const ClientState &base, unsigned int index) {
+    return index < base.missile_count ? base.missiles[index] : EMPTY_CLIENT.missiles[0];
+}
+
+/*
+ * A client is its id, then its schema fields as a delta. A flag tells whether the missiles changed, in
+ * which case the count follows and every missile gets a changed bit, set and followed by a delta of the
+ * missile. Missile i is compared with missile i of the base, so a steady stream of missiles sends their
+ * movement only.
+ */
+static void WriteClientDelta(Roar::BitWriter &writer, const ClientState &client, const ClientState &base) {
+    unsigned int missile_count = std::min(client.missile_count, (unsigned int)MAX_MISSILES_CLIENT);
+    bool changed[MAX_MISSILES_CLIENT];
+    bool missilesChanged = missile_count != base.missile_count;
 
-    if (msg.client_count > MAX_CLIENTS)
-        msg.client_count = MAX_CLIENTS;
+    for (unsigned int i = 0; i < missile_count; i++) {
+        changed[i] = Roar::FieldsChanged(MISSILE_SCHEMA, &client.missiles[i], &BaseMissile(base, i));
+        missilesChanged |= changed[i];
+    }
+
+    writer.WriteVarUInt(client.client_id);
+    Roar::WriteFieldsDelta(writer, CLIENT_SCHEMA, &client, &base);
+    writer.WriteBool(missilesChanged);
+    if (!missilesChanged)
+        return;
 
-    for (unsigned int i = 0; i < msg.client_count; i++) {
-        msg.client_states[i] = DeserializeClientState(buffer);
+    writer.WriteVarUInt(missile_count);
+    for (unsigned int i = 0; i < missile_count; i++) {
+        writer.WriteBool(changed[i]);
+        if (changed[i])
+            Roar::WriteFieldsDelta(writer, MISSILE_SCHEMA, &client.missiles[i], &BaseMissile(base, i));
     }
+}
+
+static ClientState ReadClientDelta(Roar::BitReader &reader, const GameStateMessage *base) {
+    uint32_t client_id = reader.ReadVarUInt();
+    const ClientState &baseClient = BaseClient(base, client_id);
+    ClientState client = baseClient;
+
+    client.client_id = client_id;
+    Roar::ReadFieldsDelta(reader, CLIENT_SCHEMA, &client);
+    if (!reader.ReadBool())
+        return client;
+
+    client.missile_count = std::min(reader.ReadVarUInt(), (uint32_t)MAX_MISSILES_CLIENT);
+    for (unsigned int i = 0; i < client.missile_count; i++) {
+        client.missiles[i] = BaseMissile(baseClient, i);
+        if (reader.ReadBool()) {
+            Roar::ReadFieldsDelta(reader, MISSILE_SCHEMA, &client.missiles[i]);
+            CompleteMissile(client.missiles[i]);
+        }
+    }
+    return client;
+}
+
+void SerializeGameStateDelta(Roar::INetBuffer &buffer, uint32_t tick, const GameStateMessage &state, uint32_t base_tick,
+                             const GameStateMessage *base) {
+    unsigned int client_count = std::min(state.client_count, (unsigned int)MAX_CLIENTS);
 
-    // Wave system info
-    msg.countdown_timer = buffer.ReadFloat();
-    msg.current_wave = buffer.ReadUInt32();
-    msg.wave_active = buffer.ReadUInt8() != 0;
+    buffer.WriteUInt32(tick);
+    buffer.WriteUInt32(base ? base_tick : NO_SNAPSHOT);
+
+    Roar::BitWriter writer(buffer);
+    writer.WriteVarUInt(client_count);
+    for (unsigned int i = 0; i < client_count; i++)
+        WriteClientDelta(writer, state.client_states[i], BaseClient(base, state.client_states[i].client_id));
+
+    Roar::WriteFieldsDelta(writer, WAVE_SCHEMA, &state, base ? base : &EMPTY_GAME_STATE);
+    writer.Flush();
+}
+
+void DeserializeSnapshotHeader(Roar::INetBuffer &buffer, uint32_t &tick, uint32_t &base_tick) {
+    tick = buffer.ReadUInt32();
+    base_tick = buffer.ReadUInt32();
+}
+
+GameStateMessage DeserializeGameStateDelta(Roar::INetBuffer &buffer, const GameStateMessage *base) {
+    Roar::BitReader reader(buffer);
+    GameStateMessage msg = {};
+
+    msg.client_count = std::min(reader.ReadVarUInt(), (uint32_t)MAX_CLIENTS);
+    for (unsigned int i = 0; i < msg.client_count; i++)
+        msg.client_states[i] = ReadClientDelta(reader, base);
+
+    if (base) {
+        msg.countdown_timer = base->countdown_timer;
+        msg.current_wave = base->current_wave;
+        msg.wave_active = base->wave_active;
+    }
+    Roar::ReadFieldsDelta(reader, WAVE_SCHEMA, &msg);
 
     return msg;
 }
@@ -8,6 +8,9 @@ typedef enum { TITLE = 0, IP_ADDRESS, GAMEPLAY } GameScreen;
 constexpr auto MAX_INPUT_CHARS = 15;
 constexpr auto WIDTH = 800;
 constexpr auto HEIGHT = 600;
+// Sprite layers, missiles draw over the ships
+constexpr uint16_t PLAYER_LAYER = 0;
+constexpr uint16_t MISSILE_LAYER = 1;
 
 void InitClient(char *serverIp);
 void DrawMissiles(void);
@@ -25,9 +28,11 @@ struct {
 
     ClientState m_localClientState; // The state of the local client
 
+    SnapshotHistory m_snapshots; // Game states received, the bases of the deltas that follow
+    uint32_t m_ackTick;          // Tick of the latest one, acknowledged with every state update
+
     GameScreen m_currentScreen;
     std::vector<int> m_updatedIds;
-    std::vector<Rectangle> m_missileAnimationRectangles;
     std::vector<Missile> m_missiles;
     std::vector<ClientState *> m_clients;
     unsigned int m_clientCount;
@@ -39,9 +44,11 @@ struct {
     Rectangle m_textBox;
     int m_framesCounter;
     bool m_displayHUD;
-    Texture2D m_player;
-    Texture2D m_background;
-    Texture2D m_mob;
+    Roar::TextureHandle m_player;
+    Roar::TextureHandle m_background;
+    Roar::TextureHandle m_mob;
+    Roar::SpriteBatch m_sprites; // players and missiles of the frame, drawn together
+    Roar::NetBufferPool m_buffers; // every datagram sent and received goes through these
     Rectangle m_mobBox;
 } state;
 
@@ -64,6 +71,8 @@ static void init() {
     state.m_serverCloseCode = 0;
     state.m_localClientId = 0;
     state.m_heartbeatTimer = 0;
+    ClearSnapshots(state.m_snapshots);
+    state.m_ackTick = NO_SNAPSHOT;
     state.m_currentScreen = TITLE;
     state.m_updatedIds = {0};
     state.m_clientCount = 0;
@@ -74,14 +83,9 @@ static void init() {
     state.m_textBox = {GAME_WIDTH / 2.0f - 170, 180, 365, 50};
     state.m_framesCounter = 0;
     state.m_displayHUD = false;
-    state.m_player = {0};
-    state.m_background = {0};
-    state.m_mob = {0};
-    state.m_missileAnimationRectangles.push_back({0, 128, 25, 22});
-    state.m_missileAnimationRectangles.push_back({25, 128, 31, 22});
-    state.m_missileAnimationRectangles.push_back({56, 128, 40, 22});
-    state.m_missileAnimationRectangles.push_back({96, 128, 55, 22});
-    state.m_missileAnimationRectangles.push_back({151, 128, 72, 22});
+    state.m_player = {};
+    state.m_background = {};
+    state.m_mob = {};
 
     state.m_clients.push_back(nullptr);
     state.m_clients.push_back(nullptr);
@@ -97,9 +101,9 @@ static void init() {
 
     SetTargetFPS(100);
 
-    state.m_player = LoadTexture("resources/sprites/player_r-9c_war-head.png");
-    state.m_background = LoadTexture("resources/sprites/space_background.png");
-    state.m_mob = LoadTexture("resources/sprites/mob_bydo_minions.png");
+    state.m_player = Roar::Assets().AcquireTextureAsync("resources/sprites/player_r-9c_war-head.png");
+    state.m_background = Roar::Assets().AcquireTextureAsync("resources/sprites/space_background.png");
+    state.m_mob = Roar::Assets().AcquireTextureAsync("resources/sprites/mob_bydo_minions.png");
 }
 
 static void SpawnLocalClient(int x, int y, uint32_t client_id) {
@@ -207,7 +211,23 @@ static void HandleGameStateMessage(Roar::NetBuffer &buffer) {
     if (!state.m_spawned)
         return;
 
-    GameStateMessage msg = DeserializeGameStateMessage(buffer);
+    uint32_t tick;
+    uint32_t base_tick;
+    DeserializeSnapshotHeader(buffer, tick, base_tick);
+
+    // Late or duplicated datagram, a newer snapshot was already applied
+    if (state.m_ackTick != NO_SNAPSHOT && tick <= state.m_ackTick)
+        return;
+
+    const GameStateMessage *base = FindSnapshot(state.m_snapshots, base_tick);
+    if (base_tick != NO_SNAPSHOT && base == NULL) {
+        TraceLog(LOG_DEBUG, "Dropped snapshot %u, base %u is gone", tick, base_tick);
+        return;
+    }
+
+    GameStateMessage msg = DeserializeGameStateDelta(buffer, base);
+    StoreSnapshot(state.m_snapshots, tick, msg);
+    state.m_ackTick = tick;
 
     for (int i = 0; i < MAX_CLIENTS; i++)
         state.m_updatedIds[i] = -1;
@@ -229,7 +249,8 @@ static void HandleGameStateMessage(Roar::NetBuffer &buffer) {
 }
 
 static void HandleReceivedMessages(void) {
-    Roar::NetBuffer buffer;
+    Roar::NetBufferPool::Lease lease = state.m_buffers.Acquire();
+    Roar::NetBuffer &buffer = *lease;
 
     while (client->Receive(buffer) > 0) {
         if (!buffer.CanRead(1)) {
@@ -258,7 +279,8 @@ static void HandleReceivedMessages(void) {
 }
 
 static int SendConnectRequest(void) {
-    Roar::NetBuffer buffer;
+    Roar::NetBufferPool::Lease lease = state.m_buffers.Acquire();
+    Roar::NetBuffer &buffer = *lease;
     buffer.WriteUInt8(MSG_CONNECT_REQUEST);
 
     if (!client->Send(buffer)) {
@@ -273,12 +295,14 @@ static int SendPositionUpdate(void) {
     if (!state.m_connected || state.m_disconnected)
         return 0;
 
-    Roar::NetBuffer buffer;
+    Roar::NetBufferPool::Lease lease = state.m_buffers.Acquire();
+    Roar::NetBuffer &buffer = *lease;
     buffer.WriteUInt8(MSG_UPDATE_STATE);
 
     UpdateStateMessage msg;
     msg.x = state.m_localClientState.x;
     msg.y = state.m_localClientState.y;
+    msg.ack_tick = state.m_ackTick;
     msg.missile_count = std::min((unsigned int)state.m_missiles.size(), (unsigned int)MAX_MISSILES_CLIENT);
     memcpy(msg.missiles, state.m_missiles.data(), msg.missile_count * sizeof(Missile));
 
@@ -294,7 +318,8 @@ static void SendHeartbeat(void) {
     if (!state.m_connected || state.m_disconnected)
         return;
 
-    Roar::NetBuffer buffer;
+    Roar::NetBufferPool::Lease lease = state.m_buffers.Acquire();
+    Roar::NetBuffer &buffer = *lease;
     buffer.WriteUInt8(MSG_HEARTBEAT);
     client->Send(buffer);
 }
@@ -333,22 +358,22 @@ static int UpdateGameplay(void) {
     return 0;
 }
 
-static void DrawClient(ClientState *client_state, bool is_local) {
+static void DrawClient(ClientState *client_state) {
     float frameWidth = 32;
     float frameHeight = 22.0f;
     Rectangle sourceRec = {0.0f, 30.0f, frameWidth, frameHeight};
-    Rectangle rec = {(float)client_state->x, (float)client_state->y, frameWidth * 2.0f, frameHeight * 2.0f};
     Rectangle destRec = {(float)client_state->x, (float)client_state->y, frameWidth * 2.0f, frameHeight * 2.0f};
-    Vector2 origin = {0.0f, 0.0f};
 
-    // NOTE: Using DrawTexturePro() we can easily rotate and scale the part of the texture we draw
+    // NOTE: The sprite is queued and drawn by the next flush of m_sprites
     // source_rect defines the part of the texture we use for drawing
     // dest_rect defines the rectangle where our texture part will fit (scaling it to fit)
-    // origin defines the point of the texture used as reference for rotation and scaling
-    // rotation defines the texture rotation (using origin as rotation point)
-    DrawTexturePro(state.m_player, sourceRec, destRec, origin, 0.0f, WHITE);
-    if (is_local)
-        DrawRectangleLinesEx(rec, 3, DARKBROWN);
+    state.m_sprites.Draw(state.m_player, PLAYER_LAYER, sourceRec, destRec, WHITE);
+}
+
+static void DrawLocalOutline(void) {
+    Rectangle rec = {(float)state.m_localClientState.x, (float)state.m_localClientState.y, 32 * 2.0f, 22.0f * 2.0f};
+
+    DrawRectangleLinesEx(rec, 3, DARKBROWN);
 }
 
 static void DrawHUD(void) {
@@ -364,7 +389,7 @@ static void DrawBackground(void) {
     Rectangle dest_rect = { 0.0f , 0.0f, GAME_WIDTH, GAME_HEIGHT};
     Vector2 origin = { 0.0f, 0.0f };
 
-    DrawTexturePro(state.m_background, source_rect, dest_rect, origin, 0.0f, WHITE);
+    DrawTexturePro(Roar::Assets().GetTexture(state.m_background), source_rect, dest_rect, origin, 0.0f, WHITE);
 }
 
 static void DrawGameplay(void) {
@@ -385,14 +410,18 @@ static void DrawGameplay(void) {
         // Draw the remote clients
         for (int i = 0; i < MAX_CLIENTS - 1; i++) {
             if (state.m_clients[i])
-                DrawClient(state.m_clients[i], false);
+                DrawClient(state.m_clients[i]);
         }
 
         // Draw the local client
-        DrawClient(&state.m_localClientState, true);
+        DrawClient(&state.m_localClientState);
 
         DrawMissiles();
 
+        // Every sprite shares the player texture, one batch
+        state.m_sprites.Flush();
+        DrawLocalOutline();
+
         if (state.m_displayHUD) {
             DrawHUD();
         }
@@ -503,13 +532,13 @@ void Fire(void) {
 
     missile.pos.x = state.m_localClientState.x;
     missile.pos.y = state.m_localClientState.y;
-    missile.rect.x = state.m_missileAnimationRectangles[missile.currentFrame].x;
-    missile.rect.y = state.m_missileAnimationRectangles[missile.currentFrame].y;
-    missile.rect.height = state.m_missileAnimationRectangles[missile.currentFrame].height;
-    missile.rect.width = state.m_missileAnimationRectangles[missile.currentFrame].width;
+    missile.rect = MISSILE_FRAMES[missile.currentFrame];
     state.m_missiles.push_back(missile);
 }
 
+// Remote missiles are sent whether or not they are in view
+static bool OnScreen(Rectangle rect) { return CheckCollisionRecs(rect, Rectangle{0, 0, GAME_WIDTH, GAME_HEIGHT}); }
+
 void DrawMissiles(void) {
     state.m_missiles.erase(std::remove_if(state.m_missiles.begin(), state.m_missiles.end(),
                                           [](Missile missile) {
@@ -527,12 +556,9 @@ void DrawMissiles(void) {
         if (missile.framesCounter >= (100 / missile.framesSpeed)) {
             missile.framesCounter = 0;
             missile.currentFrame++;
-            if (missile.currentFrame > 4)
+            if (missile.currentFrame >= MISSILE_FRAME_COUNT)
                 missile.currentFrame = 0;
-            missile.rect.x = state.m_missileAnimationRectangles[missile.currentFrame].x;
-            missile.rect.y = state.m_missileAnimationRectangles[missile.currentFrame].y;
-            missile.rect.height = state.m_missileAnimationRectangles[missile.currentFrame].height;
-            missile.rect.width = state.m_missileAnimationRectangles[missile.currentFrame].width;
+            missile.rect = MISSILE_FRAMES[missile.currentFrame];
         }
 
         missile.pos.x += 5;
@@ -542,9 +568,8 @@ void DrawMissiles(void) {
         Rectangle sourceRec = {missile.rect.x, missile.rect.y, frameWidth, frameHeight};
         Rectangle rec = {(float)missile.pos.x, (float)missile.pos.y, frameWidth * 2.0f, frameHeight * 2.0f};
         Rectangle destRec = {(float)missile.pos.x, (float)missile.pos.y, frameWidth * 2.0f, frameHeight * 2.0f};
-        Vector2 origin = {0.0f, 0.0f};
 
-        DrawTexturePro(state.m_player, sourceRec, destRec, origin, 0.0f, WHITE);
+        state.m_sprites.Draw(state.m_player, MISSILE_LAYER, sourceRec, destRec, WHITE);
     }
 
     for (int i = 0; i < MAX_CLIENTS - 1; i++) {
@@ -556,9 +581,9 @@ void DrawMissiles(void) {
                 Rectangle sourceRec = {missile.rect.x, missile.rect.y, frameWidth, frameHeight};
                 Rectangle rec = {(float)missile.pos.x, (float)missile.pos.y, frameWidth * 2.0f, frameHeight * 2.0f};
                 Rectangle destRec = {(float)missile.pos.x, (float)missile.pos.y, frameWidth * 2.0f, frameHeight * 2.0f};
-                Vector2 origin = {0.0f, 0.0f};
 
-                DrawTexturePro(state.m_player, sourceRec, destRec, origin, 0.0f, WHITE);
+                if (OnScreen(destRec))
+                    state.m_sprites.Draw(state.m_player, MISSILE_LAYER, sourceRec, destRec, WHITE);
             }
         }
     }
@@ -568,15 +593,15 @@ static void frame() { UpdateAndDraw(); }
 
 static void cleanup() {
 
-    UnloadTexture(state.m_player);
-    UnloadTexture(state.m_background);
-    UnloadTexture(state.m_mob);
+    Roar::Assets().Release(state.m_player);
+    Roar::Assets().Release(state.m_background);
+    Roar::Assets().Release(state.m_mob);
 
     // Send disconnect message if connected
     if (state.m_clientInitialized && state.m_connected && !state.m_disconnected) {
-        Roar::NetBuffer buffer;
-        buffer.WriteUInt8(MSG_DISCONNECT);
-        client->Send(buffer);
+        Roar::NetBufferPool::Lease lease = state.m_buffers.Acquire();
+        lease->WriteUInt8(MSG_DISCONNECT);
+        client->Send(*lease);
     }
 
     delete client;
@@ -1,13 +1,18 @@
 #include "framework.h"
+#include "JobSystem.h"
 #include "RoarEngine.h"
 #include "r-type.h"
 
+// Datagrams drained from the socket per ReceiveBatch() call
+constexpr size_t RECEIVE_BATCH = 16;
+
 // A simple structure to represent connected clients
 struct ConnectedClient {
     uint32_t client_id;
     sockaddr_in address;
     ClientState state;
     unsigned int last_heard_tick; // For timeout detection
+    uint32_t acked_tick;          // Latest snapshot the client received, the base of its next delta
 };
 
 struct {
@@ -15,7 +20,20 @@ struct {
     std::unordered_map<uint32_t, ConnectedClient> m_clients;
     uint32_t m_nextClientId = 1;
     unsigned int m_currentTick = 0;
-    float tick_dt;
+
+    // Game states broadcast over the last ticks, by tick
+    SnapshotHistory m_snapshots;
+
+    // Every datagram sent goes through these, one per client while broadcasting
+    Roar::NetBufferPool m_buffers{Roar::MAX_DATAGRAM_SIZE, MAX_CLIENTS + 1};
+    std::vector<ConnectedClient *> m_broadcastTargets;
+    std::vector<Roar::NetBufferPool::Lease> m_broadcastBuffers;
+    std::vector<Roar::NetPacket> m_outgoing;
+
+    // Client messages are small, received a batch at a time into buffers held for good
+    Roar::NetBufferPool m_receiveBuffers{4096, RECEIVE_BATCH};
+    std::vector<Roar::NetBufferPool::Lease> m_receiveLeases;
+    std::vector<Roar::NetPacket> m_received;
 
     // Spawn positions
     std::vector<Vector2> m_spawns;
@@ -36,7 +54,12 @@ static void init() {
     }
 
     state.m_spawns = {{50, 50}, {GAME_WIDTH - 100, 50}, {50, GAME_HEIGHT - 100}, {GAME_WIDTH - 100, GAME_HEIGHT - 100}};
-    state.tick_dt = 1.0f / TICK_RATE;
+    ClearSnapshots(state.m_snapshots);
+
+    for (size_t i = 0; i < RECEIVE_BATCH; i++) {
+        state.m_receiveLeases.push_back(state.m_receiveBuffers.Acquire());
+        state.m_received.push_back(Roar::NetPacket{&*state.m_receiveLeases.back(), {}});
+    }
 }
 
 static bool AddressEquals(const sockaddr_in &a, const sockaddr_in &b) {
@@ -69,10 +92,11 @@ static void HandleConnectRequest(const sockaddr_in &from) {
     if (state.m_clients.size() >= MAX_CLIENTS) {
         TraceLog(LOG_INFO, "Server full, rejecting connection");
 
-        Roar::NetBuffer rejectBuffer;
+        Roar::NetBufferPool::Lease lease = state.m_buffers.Acquire();
+        Roar::NetBuffer &rejectBuffer = *lease;
         rejectBuffer.WriteUInt8(MSG_CONNECT_REJECT);
         rejectBuffer.WriteInt32(SERVER_FULL_CODE);
-        state.m_netServer->SendTo(rejectBuffer, from);
+        server->SendTo(rejectBuffer, from);
         return;
     }
 
@@ -89,11 +113,13 @@ static void HandleConnectRequest(const sockaddr_in &from) {
     newClient.state.missile_count = 0;
     memset(newClient.state.missiles, 0, sizeof(newClient.state.missiles));
     newClient.last_heard_tick = state.m_currentTick;
+    newClient.acked_tick = NO_SNAPSHOT;
 
     state.m_clients[client_id] = newClient;
 
     // Send accept message
-    Roar::NetBuffer acceptBuffer;
+    Roar::NetBufferPool::Lease lease = state.m_buffers.Acquire();
+    Roar::NetBuffer &acceptBuffer = *lease;
     acceptBuffer.WriteUInt8(MSG_CONNECT_ACCEPT);
 
     ConnectAcceptData acceptData;
@@ -115,7 +141,7 @@ static void HandleDisconnect(uint32_t client_id) {
     }
 }
 
-static void HandleUpdateStateMessage(Roar::NetBuffer &buffer, uint32_t client_id) {
+static void HandleUpdateStateMessage(Roar::INetBuffer &buffer, uint32_t client_id) {
     auto it = state.m_clients.find(client_id);
     if (it == state.m_clients.end())
         return;
@@ -129,9 +155,13 @@ static void HandleUpdateStateMessage(Roar::NetBuffer &buffer, uint32_t client_id
     memset(it->second.state.missiles, 0, sizeof(it->second.state.missiles));
     memcpy(it->second.state.missiles, msg.missiles, msg.missile_count * sizeof(Missile));
     it->second.last_heard_tick = state.m_currentTick;
+
+    // Acks of snapshots not sent yet are bogus, older ones arrived out of order
+    if (msg.ack_tick <= state.m_currentTick && (it->second.acked_tick == NO_SNAPSHOT || msg.ack_tick > it->second.acked_tick))
+        it->second.acked_tick = msg.ack_tick;
 }
 
-static void HandleReceivedMessage(Roar::NetBuffer &buffer, const sockaddr_in &from) {
+static void HandleReceivedMessage(Roar::INetBuffer &buffer, const sockaddr_in &from) {
     if (!buffer.CanRead(1))
         return;
 
@@ -189,8 +219,7 @@ static int BroadcastGameState(void) {
         return 0;
 
     // Build game state message
-    GameStateMessage gameState;
-    gameState.client_count = 0;
+    GameStateMessage gameState = {};
 
     for (auto &[id, client] : state.m_clients) {
         if (gameState.client_count < MAX_CLIENTS) {
@@ -199,26 +228,60 @@ static int BroadcastGameState(void) {
         }
     }
 
-    // Send to all clients
+    StoreSnapshot(state.m_snapshots, state.m_currentTick, gameState);
+
+    // Each client's snapshot is serialized from its own job, then all of them go out in one batch
+    std::vector<ConnectedClient *> &clients = state.m_broadcastTargets;
+    std::vector<Roar::NetBufferPool::Lease> &buffers = state.m_broadcastBuffers;
+    clients.clear();
     for (auto &[id, client] : state.m_clients) {
-        Roar::NetBuffer buffer;
-        buffer.WriteUInt8(MSG_GAME_STATE);
-        SerializeGameStateMessage(buffer, gameState);
-        server->SendTo(buffer, client.address);
+        clients.push_back(&client);
+        buffers.push_back(state.m_buffers.Acquire());
     }
 
+    Roar::Jobs().ParallelFor(clients.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            // Delta against what the client last acknowledged, in full when that snapshot is gone
+            const GameStateMessage *base = FindSnapshot(state.m_snapshots, clients[i]->acked_tick);
+
+            buffers[i]->WriteUInt8(MSG_GAME_STATE);
+            SerializeGameStateDelta(*buffers[i], state.m_currentTick, gameState, clients[i]->acked_tick, base);
+        }
+    });
+
+    state.m_outgoing.clear();
+    for (size_t i = 0; i < clients.size(); i++) {
+        if (buffers[i]->Overflowed()) {
+            TraceLog(LOG_WARNING, "Game state does not fit a datagram (ID: %d)", clients[i]->client_id);
+            continue;
+        }
+        state.m_outgoing.push_back(Roar::NetPacket{&*buffers[i], clients[i]->address});
+    }
+    int sent = server->SendBatch(state.m_outgoing);
+    buffers.clear();
+
+    if (sent < (int)state.m_outgoing.size())
+        TraceLog(LOG_WARNING, "Sent %d game states out of %d", sent, (int)state.m_outgoing.size());
     return 0;
 }
 
-static void frame() {
-    Roar::NetBuffer recvBuffer;
-    sockaddr_in from;
+// Receive and process messages a batch at a time, parsed where the socket left them. A batch that comes
+// back short emptied the socket.
+static void ReceiveMessages() {
+    int received;
 
-    // Receive and process messages
-    while (server->Receive(recvBuffer, from) > 0) {
-        HandleReceivedMessage(recvBuffer, from);
-        recvBuffer.Clear();
-    }
+    do {
+        received = server->ReceiveBatch(state.m_received);
+        for (int i = 0; i < received; i++)
+            HandleReceivedMessage(*state.m_received[i].buffer, state.m_received[i].address);
+    } while (received == (int)state.m_received.size());
+}
+
+static SOCKET_TYPE ServerFd() { return server->GetFd(); }
+
+static void frame() {
+    // Already drained as datagrams arrived where the engine can wait on the socket
+    ReceiveMessages();
 
     // Check for client timeouts
     CheckClientTimeouts();
@@ -230,15 +293,6 @@ static void frame() {
     }
 
     state.m_currentTick++;
-
-    // Cap simulation rate
-#if defined(_WIN32) || defined(_WIN64)
-    Sleep((DWORD)(state.tick_dt * 1000));
-#else
-    long nanos = (long)(state.tick_dt * 1e9);
-    struct timespec t = {.tv_sec = nanos / 999999999, .tv_nsec = nanos % 999999999};
-    nanosleep(&t, &t);
-#endif
 }
 
 static void cleanup() {
@@ -254,5 +308,8 @@ int main(int argc, char *argv) {
                                .headless = true,
                                .init = init,
                                .frame = frame,
-                               .cleanup = cleanup});
+                               .cleanup = cleanup,
+                               .tickRate = TICK_RATE,
+                               .eventFd = ServerFd,
+                               .event = ReceiveMessages});
 }